@@ -5,13 +5,37 @@
 #include <vector>
 #include <filesystem>
 #include <sys/stat.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <io.h>       // _commit
+#endif
 #include <cstring>      // strchr
 #include <unordered_set>
+#include <unordered_map>
+#include <deque>
+#include <list>
 #include <set>
+#include <map>
 #include <cctype>       // isdigit
-#include <sstream>
+#include <string_view>
+#include <charconv>
 #include <algorithm>
 #include <cmath>
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define FPSHD_SIMD_X86 1
+#endif
 using namespace std;
 namespace fs = std::filesystem;
 
@@ -63,16 +87,158 @@ void setup_font()
     g_ui_font = g_font_ok ? font_named("ui_font") : nullptr;
 }
 
+// Rendered labels per (text, size, colour) and measured widths per (text,
+// size), each kept in LRU order. A label is rasterised the second time it is
+// drawn, so text that changes every frame (counters, typed input) is drawn
+// directly and never churns the bitmaps. Bitmaps are evicted past
+// budget_bytes, and entries of either kind past max_entries.
+struct TextCache
+{
+    struct Key
+    {
+        string_view text;
+        int size;
+        uint32_t rgba;      // 0 for widths
+        bool operator==(const Key &o) const { return size == o.size && rgba == o.rgba && text == o.text; }
+    };
+    struct KeyHash
+    {
+        size_t operator()(const Key &k) const
+        {
+            return hash<string_view>()(k.text) ^ ((size_t)k.size * 0x9e3779b97f4a7c15ull) ^ ((size_t)k.rgba << 7);
+        }
+    };
+    struct Entry
+    {
+        string text;
+        int size;
+        uint32_t rgba;
+        int w = 0;                  // width, or the bitmap's size
+        int h = 0;
+        bitmap bmp = nullptr;       // labels only; nullptr until the second draw
+    };
+    struct Lru
+    {
+        list<Entry> order;          // most recent first
+        unordered_map<Key, list<Entry>::iterator, KeyHash> index;
+        uint64_t hits = 0, misses = 0;
+    };
+
+    size_t budget_bytes = 32u << 20;
+    size_t max_entries = 4096;
+    size_t bytes = 0;
+    uint64_t next_id = 0;
+    Lru labels, widths;
+
+    static uint32_t pack(const color &c)
+    {
+        auto ch = [](double v) { return (uint32_t)clamp((int)(v * 255.0 + 0.5), 0, 255); };
+        return ch(c.r) << 24 | ch(c.g) << 16 | ch(c.b) << 8 | ch(c.a);
+    }
+
+    // Finds `k` and moves it to the front, or adds an empty entry for it
+    Entry &touch(Lru &l, const Key &k, bool &found)
+    {
+        auto it = l.index.find(k);
+        found = it != l.index.end();
+        if (found)
+        {
+            l.order.splice(l.order.begin(), l.order, it->second);
+            return *it->second;
+        }
+        l.order.push_front({ string(k.text), k.size, k.rgba });
+        Entry &e = l.order.front();
+        l.index.emplace(Key{ e.text, e.size, e.rgba }, l.order.begin());
+        return e;
+    }
+
+    void evict(Lru &l)
+    {
+        // The front entry is the one being returned; it always stays
+        while (l.order.size() > 1 && (l.order.size() > max_entries || (&l == &labels && bytes > budget_bytes)))
+        {
+            Entry &e = l.order.back();
+            if (e.bmp != nullptr) { free_bitmap(e.bmp); bytes -= (size_t)e.w * e.h * 4; }
+            l.index.erase(Key{ e.text, e.size, e.rgba });
+            l.order.pop_back();
+        }
+    }
+
+    int width(const string &txt, int size)
+    {
+        bool found;
+        Entry &e = touch(widths, Key{ txt, size, 0 }, found);
+        if (found) { widths.hits++; return e.w; }
+        widths.misses++;
+        e.w = g_ui_font != nullptr ? text_width(txt, g_ui_font, size) : text_width(txt, "default", size);
+        int w = e.w;
+        evict(widths);
+        return w;
+    }
+
+    // The label's bitmap, or nullptr when it should be drawn directly
+    bitmap label(const string &txt, const color &c, int size)
+    {
+        if (g_ui_font == nullptr || txt.empty()) return nullptr;
+        bool found;
+        Entry &e = touch(labels, Key{ txt, size, pack(c) }, found);
+        if (found && e.bmp != nullptr) { labels.hits++; return e.bmp; }
+        labels.misses++;
+        if (!found) { evict(labels); return nullptr; }     // first sighting: remember only
+
+        e.w = text_width(txt, g_ui_font, size);
+        e.h = text_height(txt, g_ui_font, size);
+        if (e.w <= 0 || e.h <= 0) return nullptr;
+        e.bmp = create_bitmap("ui_text#" + to_string(next_id++), e.w, e.h);
+        if (e.bmp == nullptr) return nullptr;
+        // Cleared to the text's own colour at zero alpha: blending the glyphs
+        // in then leaves every pixel's RGB at that colour and its alpha at
+        // glyph coverage x colour alpha, so the blit applies alpha exactly
+        // once. A black clear would darken the RGB by the alpha first, and
+        // anti-aliased edges and translucent colours (COL_SUB) would come out
+        // darker than the directly drawn first frame.
+        color clear = c;
+        clear.a = 0;
+        clear_bitmap(e.bmp, clear);
+        draw_text_on_bitmap(e.bmp, txt, c, g_ui_font, size, 0, 0);
+        bytes += (size_t)e.w * e.h * 4;
+        bitmap b = e.bmp;
+        evict(labels);
+        return b;
+    }
+
+    // Bitmaps belong to the window; drop them all before it closes
+    void clear()
+    {
+        for (Entry &e : labels.order) if (e.bmp != nullptr) free_bitmap(e.bmp);
+        labels.order.clear(); labels.index.clear();
+        widths.order.clear(); widths.index.clear();
+        bytes = 0;
+    }
+
+    static double rate(const Lru &l) { return l.hits + l.misses ? l.hits * 100.0 / (l.hits + l.misses) : 0.0; }
+
+    string label_stats() const
+    {
+        char buf[128];
+        snprintf(buf, sizeof(buf), "text: labels %.0f%% hit (%zu, %.1f MB)   widths %.0f%% hit (%zu)",
+                 rate(labels), labels.order.size(), bytes / 1e6, rate(widths), widths.order.size());
+        return buf;
+    }
+};
+static TextCache g_text_cache;
+
 void draw_ui_text(const string &txt, const color &c, double x, double y, int size)
 {
-    if (g_ui_font != nullptr) draw_text(txt, c, g_ui_font, size, x, y);
+    bitmap b = g_text_cache.label(txt, c, size);
+    if (b != nullptr) draw_bitmap(b, x, y);
+    else if (g_ui_font != nullptr) draw_text(txt, c, g_ui_font, size, x, y);
     else draw_text(txt, c, x, y);
 }
 
 int ui_text_w(const string &txt, int size)
 {
-    if (g_ui_font != nullptr) return text_width(txt, g_ui_font, size);
-    return text_width(txt, "default", size);
+    return g_text_cache.width(txt, size);
 }
 
 int ui_text_h(const string &txt, int size)
@@ -104,19 +270,78 @@ static bool try_load_bg_base(const string &base)
     return false;
 }
 
-void setup_theme()
+// The scaled background with the dimmer already applied: one window-sized
+// bitmap per dim level in use, dropped when the window size changes. A frame
+// then costs one unscaled blit instead of a scaled draw plus a full-screen
+// alpha fill.
+struct BgCache
+{
+    int w = 0, h = 0;
+    vector<pair<int, bitmap>> by_dim;     // dim alpha (0-255) -> composite
+};
+static BgCache g_bg_cache;
+
+static void drop_bg_cache()
+{
+    for (auto &e : g_bg_cache.by_dim) free_bitmap(e.second);
+    g_bg_cache = BgCache{};
+}
+
+static int dim_level(double dim_alpha) { return (int)clampd(dim_alpha * 255.0, 0, 255); }
+
+// Cover scale and offset that centre the image over the whole window
+static void cover_placement(int ww, int wh, int bw, int bh, double &s, double &dx, double &dy)
 {
-    if (g_has_bg) return;
-    if (!has_bitmap("ui_bg"))
+    double sx = (double)ww / (double)bw;
+    double sy = (double)wh / (double)bh;
+    s  = (sx > sy) ? sx : sy; // cover
+    dx = (ww - bw * s) * 0.5;
+    dy = (wh - bh * s) * 0.5;
+}
+
+static bitmap cached_bg(int dim)
+{
+    int ww = screen_width(), wh = screen_height();
+    if (ww != g_bg_cache.w || wh != g_bg_cache.h)
     {
-        g_has_bg = try_load_bg_base("ui_bg");
-        if (!g_has_bg && fs::exists("assets")) g_has_bg = try_load_bg_base("assets/ui_bg");
+        drop_bg_cache();
+        g_bg_cache.w = ww;
+        g_bg_cache.h = wh;
     }
-    if (!g_has_bg && has_bitmap("ui_bg"))
+    for (auto &e : g_bg_cache.by_dim)
+        if (e.first == dim) return e.second;
+
+    int bw = bitmap_width(g_bg_img), bh = bitmap_height(g_bg_img);
+    if (bw <= 0 || bh <= 0 || ww <= 0 || wh <= 0) return nullptr;
+
+    bitmap out = create_bitmap("ui_bg_dim" + to_string(dim), ww, wh);
+    if (out == nullptr) return nullptr;
+    double s, dx, dy;
+    cover_placement(ww, wh, bw, bh, s, dx, dy);
+    clear_bitmap(out, COL_BG);
+    draw_bitmap_on_bitmap(out, g_bg_img, dx, dy, option_scale_bmp(s, s));
+    if (dim > 0) fill_rectangle_on_bitmap(out, rgba_color(0, 0, 0, dim), 0, 0, ww, wh);
+    g_bg_cache.by_dim.push_back({ dim, out });
+    return out;
+}
+
+void setup_theme()
+{
+    if (!g_has_bg)
     {
-        g_bg_img = bitmap_named("ui_bg");
-        g_has_bg = (g_bg_img != nullptr);
+        if (!has_bitmap("ui_bg"))
+        {
+            g_has_bg = try_load_bg_base("ui_bg");
+            if (!g_has_bg && fs::exists("assets")) g_has_bg = try_load_bg_base("assets/ui_bg");
+        }
+        if (!g_has_bg && has_bitmap("ui_bg"))
+        {
+            g_bg_img = bitmap_named("ui_bg");
+            g_has_bg = (g_bg_img != nullptr);
+        }
     }
+    // Composite the two dim levels the screens use for this window size
+    if (g_has_bg) { cached_bg(dim_level(0.35)); cached_bg(dim_level(0.45)); }
 }
 
 void draw_background_cover()
@@ -133,26 +358,27 @@ void draw_background_cover()
     int bh = bitmap_height(g_bg_img);
     if (bw <= 0 || bh <= 0 || ww <= 0 || wh <= 0) return;
 
-    double sx = (double)ww / (double)bw;
-    double sy = (double)wh / (double)bh;
-    double s  = (sx > sy) ? sx : sy; // cover
-
-    double sw = bw * s;
-    double sh = bh * s;
-    double dx = (ww - sw) * 0.5;
-    double dy = (wh - sh) * 0.5;
-
+    double s, dx, dy;
+    cover_placement(ww, wh, bw, bh, s, dx, dy);
     draw_bitmap(g_bg_img, dx, dy, option_scale_bmp(s, s));
 }
 
 void draw_bg_with_dimmer(double dim_alpha = 0.35)
 {
-    draw_background_cover();
-    if (dim_alpha > 0.0)
+    int dim = dim_level(dim_alpha);
+    if (!g_has_bg || g_bg_img == nullptr)
     {
-        color overlay = rgba_color(0,0,0, (int)clampd(dim_alpha*255.0, 0, 255));
-        fill_rectangle(overlay, 0, 0, screen_width(), screen_height());
+        // Flat background: clear straight to the dimmed colour
+        double keep = 1.0 - dim / 255.0;
+        clear_screen(make_rgb((uint8_t)(COL_BG.r * 255 * keep + 0.5), (uint8_t)(COL_BG.g * 255 * keep + 0.5),
+                              (uint8_t)(COL_BG.b * 255 * keep + 0.5)));
+        return;
     }
+    bitmap bg = cached_bg(dim);
+    if (bg != nullptr) { draw_bitmap(bg, 0, 0); return; }
+
+    draw_background_cover();
+    if (dim > 0) fill_rectangle(rgba_color(0, 0, 0, dim), 0, 0, screen_width(), screen_height());
 }
 
 // =======================================================
@@ -179,29 +405,222 @@ void draw_sep(double x1, double y1, double x2, double y2)
 // =======================================================
 // Toasts / Prompts
 // =======================================================
+static bool g_headless = false; // no window (benchmarks); toasts go to stderr
+static thread_local vector<string> *t_toast_sink = nullptr; // set on worker threads: toasts are collected, not drawn
+
+// Toasts from worker threads. post_toast never blocks; the UI thread shows
+// each message for TOAST_MS through draw_posted_toasts, oldest first.
+static const uint32_t TOAST_MS = 2500;
+static mutex g_posted_lock;
+static deque<string> g_posted;
+static uint32_t g_posted_since = 0;   // ticks when the front message was first drawn
+
+void post_toast(const string &msg)
+{
+    if (g_headless) { fprintf(stderr, "%s\n", msg.c_str()); return; }
+    lock_guard<mutex> lk(g_posted_lock);
+    if (g_posted.empty()) g_posted_since = 0;
+    g_posted.push_back(msg);
+}
+
+// Pops the oldest posted toast; false when there is none
+bool take_posted_toast(string &msg)
+{
+    lock_guard<mutex> lk(g_posted_lock);
+    if (g_posted.empty()) return false;
+    msg = std::move(g_posted.front());
+    g_posted.pop_front();
+    g_posted_since = 0;
+    return true;
+}
+
+void draw_posted_toasts()
+{
+    string msg;
+    {
+        lock_guard<mutex> lk(g_posted_lock);
+        uint32_t now = current_ticks();
+        while (!g_posted.empty() && g_posted_since != 0 && now - g_posted_since >= TOAST_MS)
+        {
+            g_posted.pop_front();
+            g_posted_since = g_posted.empty() ? 0 : now;
+        }
+        if (g_posted.empty()) return;
+        if (g_posted_since == 0) g_posted_since = now;
+        msg = g_posted.front();
+    }
+    int h = 50;
+    fill_rectangle(rgba_color(0, 0, 0, 180), 0, screen_height() - h, screen_width(), h);
+    draw_ui_text(msg, COL_EMPH, 16, screen_height() - h + 14, 18);
+}
+
+// =======================================================
+// Scene loop: redraw on change, poll slowly when idle
+// =======================================================
+// Process CPU time (all threads) as a share of one core, over wall time
+struct CpuMeter
+{
+    clock_t cpu = clock();
+    chrono::steady_clock::time_point wall = chrono::steady_clock::now();
+    double percent = 0.0;
+
+    // Refreshes `percent` at most once a second; true when it did
+    bool sample()
+    {
+        auto now = chrono::steady_clock::now();
+        double wall_ms = chrono::duration<double, milli>(now - wall).count();
+        if (wall_ms < 1000.0) return false;
+        clock_t c = clock();
+        percent = (double)(c - cpu) * 1000.0 / CLOCKS_PER_SEC / wall_ms * 100.0;
+        cpu = c;
+        wall = now;
+        return true;
+    }
+};
+
+// F3 toggles a corner overlay on every scene: CPU use, redraws per second,
+// the cost of the last frame and the text cache's hit rates
+struct SceneStats
+{
+    bool overlay = false;
+    CpuMeter cpu;
+    uint64_t frames = 0, frames_at_sample = 0;
+    double redraws_per_s = 0.0, last_draw_ms = 0.0;
+
+    bool sample()
+    {
+        if (!cpu.sample()) return false;
+        redraws_per_s = (double)(frames - frames_at_sample);
+        frames_at_sample = frames;
+        return true;
+    }
+};
+static SceneStats g_scene;
+
+enum class Step { STAY, CHANGED, LEAVE };
+
+static const uint32_t POLL_MS = 10;          // between polls while input is recent
+static const uint32_t IDLE_POLL_MS = 50;     // once nothing has happened for IDLE_AFTER_MS
+static const uint32_t IDLE_AFTER_MS = 1000;
+static const uint32_t KEEPALIVE_MS = 1000;   // idle screens still redraw this often
+
+static bool has_posted_toasts()
+{
+    lock_guard<mutex> lk(g_posted_lock);
+    return !g_posted.empty();
+}
+
+static void poll_delay(uint32_t last_input)
+{
+    delay(current_ticks() - last_input < IDLE_AFTER_MS ? POLL_MS : IDLE_POLL_MS);
+}
+
+static void draw_scene_overlay()
+{
+    char buf[128];
+    snprintf(buf, sizeof(buf), "CPU %.1f%%   %.0f redraws/s   last frame %.2f ms",
+             g_scene.cpu.percent, g_scene.redraws_per_s, g_scene.last_draw_ms);
+    string text = g_text_cache.label_stats();
+    int tw = max(ui_text_w(buf, 14), ui_text_w(text, 14));
+    fill_rectangle(COL_HUD, screen_width() - tw - 20, 52, tw + 12, 42);
+    draw_ui_text(buf, COL_SUB, screen_width() - tw - 14, 56, 14);
+    draw_ui_text(text, COL_SUB, screen_width() - tw - 14, 76, 14);
+}
+
+// Runs one blocking screen. Every pass polls events and calls `update`,
+// which handles input and reports whether the screen's state changed or it
+// is done. `draw` renders a whole frame and runs only when needed: the first
+// pass, CHANGED, a key/click/wheel/drag, a window resize, a posted toast, or
+// the once-a-second keep-alive. SplashKit has no call that blocks until the
+// next event, so between frames the loop sleeps instead, for POLL_MS while
+// input is recent and IDLE_POLL_MS after that.
+void run_scene(const function<void()> &draw, const function<Step()> &update)
+{
+    bool dirty = true;
+    int w = -1, h = -1;
+    uint32_t last_input = current_ticks(), last_draw = 0;
+
+    while (true)
+    {
+        process_events();
+        if (key_typed(F3_KEY)) { g_scene.overlay = !g_scene.overlay; dirty = true; }
+
+        Step step = update();
+        if (step == Step::LEAVE) return;
+
+        uint32_t now = current_ticks();
+        bool input = any_key_pressed() || mouse_clicked(LEFT_BUTTON) || mouse_down(LEFT_BUTTON)
+                     || mouse_wheel_scroll().y != 0;
+        if (input || step == Step::CHANGED) { dirty = true; last_input = now; }
+        if (screen_width() != w || screen_height() != h) { w = screen_width(); h = screen_height(); dirty = true; }
+        if (now - last_draw >= KEEPALIVE_MS) dirty = true;
+        if (now - last_draw >= 250 && has_posted_toasts()) dirty = true;
+        if (g_scene.sample() && g_scene.overlay) dirty = true;
+
+        if (!dirty) { poll_delay(last_input); continue; }
+
+        auto t0 = chrono::steady_clock::now();
+        draw();
+        draw_posted_toasts();
+        g_scene.last_draw_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+        if (g_scene.overlay) draw_scene_overlay();
+        refresh_screen(60);
+        g_scene.frames++;
+        last_draw = now;
+        dirty = false;
+    }
+}
+
+// For screens drawn once: waits for a dismiss key or click, polling with the
+// same idle back-off as run_scene
+void wait_for_dismiss()
+{
+    uint32_t since = current_ticks();
+    while (true)
+    {
+        process_events();
+        if (key_typed(RETURN_KEY) || key_typed(ESCAPE_KEY) || mouse_clicked(LEFT_BUTTON)
+            || key_typed(SPACE_KEY) || key_typed(A_KEY) || key_typed(B_KEY)) return;
+        if (any_key_pressed()) since = current_ticks();
+        poll_delay(since);
+    }
+}
+
+// A one-second notice over the current screen, dismissable early. The bar
+// is drawn over the last frame once and never redrawn: after a refresh the
+// back buffer no longer holds that frame. The wait polls like wait_for_dismiss.
 void draw_toast(const string &msg)
 {
-    color bg = rgba_color(0, 0, 0, 180);
+    if (t_toast_sink != nullptr) { t_toast_sink->push_back(msg); return; }
+    if (g_headless) { fprintf(stderr, "%s\n", msg.c_str()); return; }
+
     int h = 50;
-    fill_rectangle(bg, 0, screen_height() - h, screen_width(), h);
+    fill_rectangle(rgba_color(0, 0, 0, 180), 0, screen_height() - h, screen_width(), h);
     draw_ui_text(msg, COL_EMPH, 16, screen_height() - h + 14, 18);
     refresh_screen();
-    uint32_t start = current_ticks();
+
+    uint32_t start = current_ticks(), since = start;
     while (current_ticks() - start < 1000)
     {
         process_events();
-        if (key_typed(RETURN_KEY) || key_typed(ESCAPE_KEY) || mouse_clicked(LEFT_BUTTON)) break;
-        delay(10);
+        if (key_typed(RETURN_KEY) || key_typed(ESCAPE_KEY) || mouse_clicked(LEFT_BUTTON)) return;
+        if (any_key_pressed()) since = current_ticks();
+        poll_delay(since);
     }
 }
 
 string prompt_line(const string &prompt)
 {
-    string buf;
-    while (true)
+    string buf, result;
+    auto draw = [&]
+    {
+        draw_bg_with_dimmer(0.35);
+        draw_ui_text(prompt, COL_TEXT, 24, 64, 22);
+        draw_ui_text("Type and press Enter. ESC to cancel.", COL_SUB, 24, 94, 16);
+        draw_ui_text("> " + buf + "_", COL_EMPH, 24, 130, 20);
+    };
+    auto update = [&]
     {
-        process_events();
-
         // Letters (lowercase)
         for (int k = A_KEY; k <= Z_KEY; ++k)
         {
@@ -249,18 +668,12 @@ string prompt_line(const string &prompt)
             if (!buf.empty()) buf.pop_back();
         }
 
-        // Render
-        draw_bg_with_dimmer(0.35);
-        draw_ui_text(prompt, COL_TEXT, 24, 64, 22);
-        draw_ui_text("Type and press Enter. ESC to cancel.", COL_SUB, 24, 94, 16);
-        draw_ui_text("> " + buf + "_", COL_EMPH, 24, 130, 20);
-        refresh_screen(60);
-
-        if (key_typed(ESCAPE_KEY)) return "";
-        if (key_typed(RETURN_KEY)) return buf;
-
-        delay(16);
-    }
+        if (key_typed(ESCAPE_KEY)) return Step::LEAVE;
+        if (key_typed(RETURN_KEY)) { result = buf; return Step::LEAVE; }
+        return Step::STAY;
+    };
+    run_scene(draw, update);
+    return result;
 }
 
 bool confirm_yes(const string &question)
@@ -269,58 +682,141 @@ bool confirm_yes(const string &question)
     return (a == "y" || a == "yes");
 }
 
-void show_long_text(const string &title, const string &body)
+// Word-wrapped layout of a long text: an index of (offset, length) spans into
+// the body, one per screen line, built in a single pass from per-byte glyph
+// advances measured once. Only a width change rebuilds it, and drawing
+// touches just the lines in view, so multi-MB reports open and scroll at once.
+struct TextLayout
 {
-    // Simple wrapping
-    vector<string> lines;
+    struct Line { size_t off; uint32_t len; };
+
+    string_view body;
+    int size, line_h;
+    int width = -1;                 // wrap width the index was built for
+    vector<Line> lines;
+    float adv[256];
+
+    TextLayout(string_view text, int font_size, int pitch) : body(text), size(font_size), line_h(pitch)
+    {
+        // Kerning is ignored; layout() keeps a small margin for it
+        float wide = (float)ui_text_w("W", size);
+        for (int c = 0; c < 256; ++c)
+        {
+            if (c >= 32 && c < 127) adv[c] = (float)ui_text_w(string(1, (char)c), size);
+            else if (c >= 0xC0) adv[c] = wide;          // UTF-8 lead byte: one glyph, guessed wide
+            else adv[c] = 0.0f;                         // continuation bytes and controls
+        }
+        adv[(unsigned char)'\t'] = adv[(unsigned char)' '] * 4;
+    }
+
+    // Rebuilds the index when `w` differs from the last layout; true if it did
+    bool layout(int w)
     {
-        string cur;
-        int col = 0;
-        for (char c : body)
+        if (w == width) return false;
+        width = w;
+        lines.clear();
+        float limit = max(40.0f, w - 8.0f);
+        const char *s = body.data();
+        size_t n = body.size(), start = 0;
+        while (start <= n)
         {
-            if (c == '\n')
+            float x = 0.0f;
+            size_t i = start, brk = string_view::npos;
+            for (; i < n && s[i] != '\n'; ++i)
             {
-                lines.push_back(cur); cur.clear(); col = 0;
+                unsigned char c = (unsigned char)s[i];
+                if (c == ' ' || c == '\t') brk = i;
+                x += adv[c];
+                if (x > limit && i > start) break;
             }
-            else
+            if (i >= n || s[i] == '\n')
             {
-                cur.push_back(c);
-                if (++col >= 90) { lines.push_back(cur); cur.clear(); col = 0; }
+                if (i >= n && i == start && !lines.empty()) break;     // no empty line after a final '\n'
+                lines.push_back({ start, (uint32_t)(i - start) });
+                start = i + 1;
+                continue;
             }
+            // Overflowed at i: break after the last blank, else mid-word on a glyph boundary
+            size_t end = brk != string_view::npos && brk > start ? brk : i;
+            while (end > start + 1 && ((unsigned char)s[end] & 0xC0) == 0x80) --end;
+            lines.push_back({ start, (uint32_t)(end - start) });
+            start = end;
+            while (start < n && (s[start] == ' ' || s[start] == '\t')) ++start;
         }
-        if (!cur.empty()) lines.push_back(cur);
+        return true;
     }
 
-    int start = 0;
-    while (true)
+    string_view line(size_t i) const { return body.substr(lines[i].off, lines[i].len); }
+    double height() const { return (double)lines.size() * line_h; }
+};
+
+void show_long_text(const string &title, const string &body)
+{
+    const int TOP = 60, BOTTOM = 60, PITCH = 22;
+    TextLayout text(body, 18, PITCH);
+    double scroll = 0.0, target = 0.0;
+
+    auto view_h = [&] { return max(PITCH, screen_height() - TOP - BOTTOM); };
+    auto max_scroll = [&] { return max(0.0, text.height() - view_h()); };
+    auto relayout = [&]
     {
-        process_events();
-        draw_bg_with_dimmer(0.45);
+        // Keep the top line in view across a rewrap
+        size_t top = text.lines.empty() ? 0 : text.lines[min(text.lines.size() - 1, (size_t)(scroll / PITCH))].off;
+        if (!text.layout(screen_width() - 48 - 14)) return;
+        auto it = upper_bound(text.lines.begin(), text.lines.end(), top,
+                              [](size_t off, const TextLayout::Line &l) { return off < l.off; });
+        size_t at = it == text.lines.begin() ? 0 : (size_t)(it - text.lines.begin()) - 1;
+        scroll = target = clampd((double)at * PITCH, 0.0, max_scroll());
+    };
+    text.layout(screen_width() - 48 - 14);
 
-        draw_ui_text(title, COL_TEXT, 20, 20, 26);
+    auto draw = [&]
+    {
+        relayout();
+        draw_bg_with_dimmer(0.45);
 
         int x = 24;
-        int y = 60;
-        int max_y = screen_height() - 60;
-        int shown = 0;
+        size_t first = (size_t)(scroll / PITCH);
+        double y = TOP - (scroll - (double)first * PITCH);
+        for (size_t i = first; i < text.lines.size() && y < screen_height() - BOTTOM; ++i, y += PITCH)
+            draw_ui_text(string(text.line(i)), COL_EMPH, x, y, 18);
 
-        for (int i = start; i < (int)lines.size(); ++i)
+        if (max_scroll() > 0)
         {
-            draw_ui_text(lines[i], COL_EMPH, x, y, 18);
-            y += 22;
-            shown++;
-            if (y > max_y) break;
+            double track = view_h();
+            double thumb = max(20.0, track * view_h() / text.height());
+            fill_rectangle(COL_CARD, screen_width() - 30, TOP, 6, track);
+            fill_rectangle(COL_SUB, screen_width() - 30, TOP + (track - thumb) * scroll / max_scroll(), 6, thumb);
         }
 
-        draw_ui_text("UP/DOWN to scroll, ENTER to close", COL_SUB, 24, screen_height() - 30, 16);
-        refresh_screen(60);
-
-        if (key_typed(RETURN_KEY) || mouse_clicked(LEFT_BUTTON)) break;
-        if (key_typed(UP_KEY)) { if (start > 0) start--; }
-        if (key_typed(DOWN_KEY)) { if (start + shown < (int)lines.size()) start++; }
-
-        delay(10);
-    }
+        // Title and footer bars cover lines that are partly scrolled out
+        fill_rectangle(COL_HUD, 0, 0, screen_width(), TOP - 4);
+        fill_rectangle(COL_HUD, 0, screen_height() - BOTTOM + 4, screen_width(), BOTTOM - 4);
+        draw_ui_text(title, COL_TEXT, 20, 20, 26);
+        draw_ui_text("UP/DOWN/Wheel: scroll   PgUp/PgDn: page   Home/End   ENTER: close", COL_SUB, 24, screen_height() - 30, 16);
+    };
+    auto update = [&]
+    {
+        if (key_typed(RETURN_KEY) || key_typed(ESCAPE_KEY) || mouse_clicked(LEFT_BUTTON)) return Step::LEAVE;
+        double page = max(1, view_h() / PITCH - 1) * PITCH;
+        double wheel = mouse_wheel_scroll().y;
+        if (wheel != 0) target -= wheel * 3 * PITCH;
+        if (key_typed(UP_KEY)) target -= PITCH;
+        if (key_typed(DOWN_KEY)) target += PITCH;
+        if (key_typed(PAGE_UP_KEY)) target -= page;
+        if (key_typed(PAGE_DOWN_KEY)) target += page;
+        if (key_typed(HOME_KEY)) target = 0;
+        if (key_typed(END_KEY)) target = max_scroll();
+        target = clampd(target, 0.0, max_scroll());
+
+        // Ease towards the target; jumps of more than a screen land a screen short
+        double d = target - scroll;
+        if (d == 0.0) return Step::STAY;
+        if (fabs(d) > view_h()) scroll = target - (d > 0 ? view_h() : -view_h());
+        scroll = fabs(target - scroll) < 0.5 ? target : scroll + (target - scroll) * 0.35;
+        return Step::CHANGED;
+    };
+    run_scene(draw, update);
 }
 
 // =======================================================
@@ -340,24 +836,22 @@ struct Session
     string session_date;
 };
 
-struct Player
-{
-    string player_name;
-    string preferred_game;
-    vector<Session> sessions;          // MIGRATED: std::vector
-    vector<string> achievements;       // ids of unlocked achievements
-};
-
-const int MAX_ALLOWED = 20;
-
 // =======================================================
 // Utilities
 // =======================================================
-GameType parse_game_type(const string &s)
+// ASCII case-insensitive compare; `lower` must already be lowercase
+static bool iequals(string_view s, string_view lower)
+{
+    if (s.size() != lower.size()) return false;
+    for (size_t i = 0; i < s.size(); ++i)
+        if (tolower((unsigned char)s[i]) != lower[i]) return false;
+    return true;
+}
+
+GameType parse_game_type(string_view s)
 {
-    string t = to_lowercase(s);
-    if (t == "valorant") return GameType::Valorant;
-    if (t == "cs:go" || t == "csgo" || t == "cs 2" || t == "cs2") return GameType::CSGO;
+    if (iequals(s, "valorant")) return GameType::Valorant;
+    if (iequals(s, "cs:go") || iequals(s, "csgo") || iequals(s, "cs 2") || iequals(s, "cs2")) return GameType::CSGO;
     return GameType::Unknown;
 }
 
@@ -371,8 +865,97 @@ string game_type_to_string(GameType g)
     }
 }
 
-bool is_win(const string &outcome) { return to_lowercase(outcome) == "win"; }
-bool is_loss(const string &outcome) { return to_lowercase(outcome) == "loss"; }
+enum Outcome : uint8_t { OUTCOME_OTHER = 0, OUTCOME_WIN = 1, OUTCOME_LOSS = 2 };
+
+Outcome parse_outcome_id(string_view outcome)
+{
+    if (iequals(outcome, "win"))  return OUTCOME_WIN;
+    if (iequals(outcome, "loss")) return OUTCOME_LOSS;
+    return OUTCOME_OTHER;
+}
+
+bool is_win(string_view outcome) { return parse_outcome_id(outcome) == OUTCOME_WIN; }
+bool is_loss(string_view outcome) { return parse_outcome_id(outcome) == OUTCOME_LOSS; }
+
+// -----------------------------------------
+// Rank ladders: rank text -> ordinal (higher is better, 0 = not on the ladder)
+// -----------------------------------------
+struct RankStep
+{
+    const char *name;       // lowercase, single spaces
+    const char *alias;      // common short form, or nullptr
+    int divisions;          // 0 = a single step with no division number
+};
+
+static const RankStep VALORANT_LADDER[] = {
+    { "iron", nullptr, 3 }, { "bronze", nullptr, 3 }, { "silver", nullptr, 3 }, { "gold", nullptr, 3 },
+    { "platinum", "plat", 3 }, { "diamond", nullptr, 3 }, { "ascendant", nullptr, 3 },
+    { "immortal", nullptr, 3 }, { "radiant", nullptr, 0 },
+};
+
+static const RankStep CSGO_LADDER[] = {
+    { "silver", "s", 4 }, { "silver elite", "se", 0 }, { "silver elite master", "sem", 0 },
+    { "gold nova", "gn", 4 }, { "gold nova master", "gnm", 0 },
+    { "master guardian", "mg", 2 }, { "master guardian elite", "mge", 0 },
+    { "distinguished master guardian", "dmg", 0 },
+    { "legendary eagle", "le", 0 }, { "legendary eagle master", "lem", 0 },
+    { "supreme master first class", "smfc", 0 }, { "global elite", "ge", 0 },
+};
+
+// Division suffix: 1-9 or roman i..iv
+static int rank_division(string_view t)
+{
+    if (t.size() == 1 && t[0] >= '1' && t[0] <= '9') return t[0] - '0';
+    if (t == "i") return 1;
+    if (t == "ii") return 2;
+    if (t == "iii") return 3;
+    if (t == "iv") return 4;
+    return 0;
+}
+
+int rank_ordinal(GameType g, string_view rank)
+{
+    const RankStep *ladder = nullptr; size_t steps = 0;
+    if (g == GameType::Valorant) { ladder = VALORANT_LADDER; steps = sizeof(VALORANT_LADDER) / sizeof(RankStep); }
+    else if (g == GameType::CSGO) { ladder = CSGO_LADDER; steps = sizeof(CSGO_LADDER) / sizeof(RankStep); }
+    else return 0;
+
+    // Lowercase, collapse separators to one space, split "gold2" into "gold 2"
+    char buf[64]; size_t n = 0;
+    for (char ch : rank)
+    {
+        unsigned char c = (unsigned char)tolower((unsigned char)ch);
+        bool sep = (c == ' ' || c == '\t' || c == '-' || c == '_');
+        if (!sep && n > 0 && isdigit(c) && isalpha((unsigned char)buf[n - 1]))
+        {
+            if (n >= sizeof(buf)) return 0;
+            buf[n++] = ' ';
+        }
+        if (sep && (n == 0 || buf[n - 1] == ' ')) continue;
+        if (n >= sizeof(buf)) return 0;
+        buf[n++] = sep ? ' ' : (char)c;
+    }
+    while (n > 0 && buf[n - 1] == ' ') --n;
+    string_view text(buf, n), head = text;
+    int division = 0;
+    size_t sp = text.rfind(' ');
+    if (sp != string_view::npos && (division = rank_division(text.substr(sp + 1))) > 0) head = text.substr(0, sp);
+
+    int base = 0;
+    for (size_t i = 0; i < steps; ++i)
+    {
+        const RankStep &r = ladder[i];
+        int width = max(1, r.divisions);
+        if (head == r.name || (r.alias != nullptr && head == r.alias))
+        {
+            if (r.divisions == 0) return division == 0 ? base + 1 : 0;
+            if (division == 0) division = 1;
+            return division <= r.divisions ? base + division : 0;
+        }
+        base += width;
+    }
+    return 0;
+}
 
 double kda_for(const Session &s)
 {
@@ -389,1489 +972,4980 @@ static GameType normalized_game_type(GameType t, const string &name)
 }
 
 // =======================================================
-// Input with exceptions
+// Session store (growable; keeps a pre-parsed date key per row)
 // =======================================================
-int parse_int_in_range(const string &prompt, int lo, int hi)
+static bool parse_digits(string_view s, int &out)
 {
-    string s = prompt_line(prompt);
-    if (s == "") throw runtime_error("No input provided.");
-    if (!is_integer(s)) throw runtime_error("Please enter a valid integer.");
-    int v = convert_to_integer(s);
-    if (v < lo || v > hi) throw runtime_error("Value must be between " + to_string(lo) + " and " + to_string(hi) + ".");
-    return v;
+    const char *end = s.data() + s.size();
+    auto r = from_chars(s.data(), end, out);
+    return r.ec == errc() && r.ptr == end && s[0] != '-';
 }
 
-string parse_nonempty(const string &prompt)
+bool parse_date_key(string_view ymd, int &key_out)
 {
-    string s = prompt_line(prompt);
-    if (s == "") throw runtime_error("Input cannot be empty.");
-    return s;
+    if (ymd.size() != 10 || ymd[4] != '-' || ymd[7] != '-') return false;
+    int y, m, d;
+    if (!parse_digits(ymd.substr(0, 4), y) || !parse_digits(ymd.substr(5, 2), m) || !parse_digits(ymd.substr(8, 2), d)) return false;
+    if (y < 1970 || y > 2100) return false;
+    if (m < 1 || m > 12) return false;
+    if (d < 1 || d > 31) return false;
+    key_out = y * 10000 + m * 100 + d;
+    return true;
 }
 
-GameType parse_game_with_name(string &out_name)
+// Interns short repeated strings (game names, rank titles) to dense ids.
+// Lookups by string_view never allocate; only a new distinct value does.
+struct StringTable
 {
-    string s = prompt_line("Game (Valorant / CS:GO):");
-    if (s == "") throw runtime_error("Input cannot be empty.");
-    GameType g = parse_game_type(s);
-    if (g == GameType::Unknown) throw runtime_error("Unsupported game. Enter Valorant or CS:GO.");
-    out_name = game_type_to_string(g);
-    return g;
-}
+    StringTable() = default;
+    StringTable(const StringTable &o) { for (const string &t : o.texts) intern(t); }
+    StringTable(StringTable &&) = default;
+    StringTable &operator=(const StringTable &o) { if (this != &o) { StringTable t(o); *this = std::move(t); } return *this; }
+    StringTable &operator=(StringTable &&) = default;
 
-string parse_outcome()
+    uint32_t intern(string_view s)
+    {
+        // Rows arrive in runs of the same game/rank; skip the hash for a repeat
+        if (last < texts.size() && texts[last] == s) return last;
+        auto it = ids.find(s);
+        if (it != ids.end()) return last = it->second;
+        texts.emplace_back(s);
+        uint32_t id = (uint32_t)(texts.size() - 1);
+        ids.emplace(string_view(texts.back()), id);
+        return last = id;
+    }
+
+    const string &text(uint32_t id) const { return texts[id]; }
+    size_t size() const { return texts.size(); }
+    void clear() { ids.clear(); texts.clear(); last = 0; }
+
+private:
+    deque<string> texts;                          // deque: views in `ids` stay valid as it grows
+    unordered_map<string_view, uint32_t> ids;
+    uint32_t last = 0;                            // id of the previous intern
+};
+
+// Struct-of-arrays mirror of the rows, same order, one entry per session.
+// Analytics loops read these contiguous ints/bytes instead of pulling whole
+// Session structs (and their strings) through the cache.
+struct SessionColumns
 {
-    string s = prompt_line("Match outcome (Win/Loss):");
-    if (s == "") throw runtime_error("Input cannot be empty.");
-    string tl = to_lowercase(s);
-    if (tl == "win") return "Win";
-    if (tl == "loss") return "Loss";
-    throw runtime_error("Outcome must be Win or Loss.");
-}
+    vector<int32_t> kills, deaths, assists;
+    vector<int32_t> date_key;    // parse_date_key result, 99999999 when unparseable
+    vector<uint8_t> outcome;     // Outcome
+    vector<uint8_t> game_type;   // GameType
+    vector<uint32_t> game_id;    // SessionStore::game_names id
+    vector<int16_t> rank_ord;    // rank_ordinal on the row's game ladder, 0 = unranked
 
-template <typename F>
-auto prompt_until_ok(F fn) -> decltype(fn())
-{
-    while (true)
+    size_t size() const { return kills.size(); }
+
+    void reserve(size_t n)
     {
-        try { return fn(); }
-        catch (const exception &e) { draw_toast(string("Invalid input: ") + e.what()); }
+        kills.reserve(n); deaths.reserve(n); assists.reserve(n);
+        date_key.reserve(n); outcome.reserve(n); game_type.reserve(n);
+        game_id.reserve(n); rank_ord.reserve(n);
     }
-}
 
-// =======================================================
-// Stats (lifetime)
-// =======================================================
-struct SummaryStats
-{
-    int total_matches = 0;
-    int wins = 0;
-    int losses = 0;
-    double avg_kda = 0.0;
-    double win_rate_percent = 0.0;
+    void clear()
+    {
+        kills.clear(); deaths.clear(); assists.clear();
+        date_key.clear(); outcome.clear(); game_type.clear();
+        game_id.clear(); rank_ord.clear();
+    }
 
-    int best_win_streak = 0;
-    int best_loss_streak = 0;
-    int best_high_kda_streak = 0;
+    void push(const Session &s, int key, uint32_t game, int rank)
+    {
+        push(s.kills, s.deaths, s.assists, key, parse_outcome_id(s.outcome), s.game_type, game, rank);
+    }
+
+    void push(int k, int d, int a, int key, Outcome o, GameType g, uint32_t game, int rank)
+    {
+        kills.push_back(k); deaths.push_back(d); assists.push_back(a);
+        date_key.push_back(key);
+        outcome.push_back(o);
+        game_type.push_back((uint8_t)g);
+        game_id.push_back(game);
+        rank_ord.push_back((int16_t)rank);
+    }
+
+    void erase(size_t i)
+    {
+        kills.erase(kills.begin() + i); deaths.erase(deaths.begin() + i); assists.erase(assists.begin() + i);
+        date_key.erase(date_key.begin() + i);
+        outcome.erase(outcome.begin() + i);
+        game_type.erase(game_type.begin() + i);
+        game_id.erase(game_id.begin() + i);
+        rank_ord.erase(rank_ord.begin() + i);
+    }
 };
 
-SummaryStats compute_summary(const Player &p)
+inline double kda_at(const SessionColumns &c, size_t i)
 {
-    SummaryStats st{};
-    st.total_matches = (int)p.sessions.size();
-    int sum_kills = 0, sum_deaths = 0, sum_assists = 0;
-    int cur_win_streak = 0, cur_loss_streak = 0, cur_high_kda_streak = 0;
+    int denom = (c.deaths[i] <= 0) ? 1 : c.deaths[i];
+    return (c.kills[i] + c.assists[i]) / static_cast<double>(denom);
+}
 
-    for (const auto &s : p.sessions)
+// -----------------------------------------
+// Streak engine: run-length encoded matches of one rule along an ordering
+// -----------------------------------------
+// Max pyramid over a growable int array: set() at or one past the end is
+// O(log n), raise() amortised O(1) for appends and growing values, and the
+// max over any [b, e) is O(log n)
+struct MaxPyramid
+{
+    vector<vector<int>> lv;
+
+    size_t size() const { return lv.empty() ? 0 : lv[0].size(); }
+    int top() const { return lv.empty() ? 0 : lv.back()[0]; }
+
+    void set(size_t i, int v)
     {
-        if (is_win(s.outcome))
+        if (lv.empty()) lv.emplace_back();
+        if (i == lv[0].size()) lv[0].push_back(v); else lv[0][i] = v;
+        for (size_t k = 0; lv[k].size() > 1; ++k, i /= 2)
         {
-            st.wins++; cur_win_streak++; st.best_win_streak = max(st.best_win_streak, cur_win_streak);
-            cur_loss_streak = 0;
+            if (k + 1 == lv.size()) lv.emplace_back();
+            size_t p = i / 2;
+            int m = lv[k][2 * p];
+            if (2 * p + 1 < lv[k].size()) m = max(m, lv[k][2 * p + 1]);
+            if (p == lv[k + 1].size()) lv[k + 1].push_back(m); else lv[k + 1][p] = m;
         }
-        else if (is_loss(s.outcome))
+    }
+
+    // Like set() for a value no smaller than the old one (or a new entry):
+    // stops at the first ancestor that already covers it
+    void raise(size_t i, int v)
+    {
+        if (lv.empty()) lv.emplace_back();
+        if (i == lv[0].size()) lv[0].push_back(v); else lv[0][i] = v;
+        for (size_t k = 0; lv[k].size() > 1; ++k, i /= 2)
         {
-            st.losses++; cur_loss_streak++; st.best_loss_streak = max(st.best_loss_streak, cur_loss_streak);
-            cur_win_streak = 0;
+            if (k + 1 == lv.size()) lv.emplace_back();
+            size_t p = i / 2;
+            if (p == lv[k + 1].size())
+                lv[k + 1].push_back(2 * p + 1 < lv[k].size() ? max(lv[k][2 * p], lv[k][2 * p + 1]) : lv[k][2 * p]);
+            else if (lv[k + 1][p] >= v) break;
+            else lv[k + 1][p] = v;
         }
-        else { cur_win_streak = cur_loss_streak = 0; }
+    }
 
-        double k = kda_for(s);
-        if (k >= 2.0) { cur_high_kda_streak++; st.best_high_kda_streak = max(st.best_high_kda_streak, cur_high_kda_streak); }
-        else cur_high_kda_streak = 0;
+    // Keeps the first n entries
+    void truncate(size_t n)
+    {
+        if (n == 0) { lv.clear(); return; }
+        for (size_t k = 0; k < lv.size(); ++k)
+        {
+            lv[k].resize(n);
+            if (k > 0)
+            {
+                size_t c = 2 * (n - 1);
+                lv[k][n - 1] = (c + 1 < lv[k - 1].size()) ? max(lv[k - 1][c], lv[k - 1][c + 1]) : lv[k - 1][c];
+            }
+            if (n == 1) { lv.resize(k + 1); break; }
+            n = (n + 1) / 2;
+        }
+    }
 
-        sum_kills += s.kills; sum_deaths += s.deaths; sum_assists += s.assists;
+    int range_max(size_t b, size_t e) const
+    {
+        int m = 0;
+        for (size_t k = 0; b < e; ++k, b >>= 1, e >>= 1)
+        {
+            if (b & 1) m = max(m, lv[k][b++]);
+            if (e & 1) m = max(m, lv[k][--e]);
+        }
+        return m;
     }
+};
 
-    double avg_deaths  = st.total_matches ? sum_deaths / (double)st.total_matches : 1.0;
-    if (avg_deaths <= 0) avg_deaths = 1.0;
-    double avg_kills   = st.total_matches ? sum_kills  / (double)st.total_matches : 0.0;
-    double avg_assists = st.total_matches ? sum_assists/ (double)st.total_matches : 0.0;
+// What a streak counts: a win, a loss, KDA at/above or below a threshold,
+// or any other per-row test
+struct StreakRule
+{
+    enum Kind : uint8_t { WIN, LOSS, KDA_AT_LEAST, KDA_BELOW, CUSTOM } kind = WIN;
+    double threshold = 0.0;
+    bool (*test_fn)(const SessionColumns &, size_t) = nullptr;    // CUSTOM only
 
-    st.avg_kda = (avg_kills + avg_assists) / avg_deaths;
-    st.win_rate_percent = st.total_matches ? (st.wins * 100.0 / st.total_matches) : 0.0;
-    return st;
-}
+    bool operator==(const StreakRule &o) const
+    {
+        return kind == o.kind && threshold == o.threshold && test_fn == o.test_fn;
+    }
 
-int find_best_session_by_kda(const Player &p)
-{
-    if (p.sessions.empty()) return -1;
-    double best = -1.0; int idx = -1;
-    for (int i = 0; i < (int)p.sessions.size(); ++i)
+    bool test(const SessionColumns &c, size_t r) const
     {
-        double k = kda_for(p.sessions[i]);
-        if (k > best) { best = k; idx = i; }
+        switch (kind)
+        {
+            case WIN:          return c.outcome[r] == OUTCOME_WIN;
+            case LOSS:         return c.outcome[r] == OUTCOME_LOSS;
+            case KDA_AT_LEAST: return kda_at(c, r) >= threshold;
+            case KDA_BELOW:    return kda_at(c, r) < threshold;
+            default:           return test_fn != nullptr && test_fn(c, r);
+        }
     }
-    return idx;
-}
+};
 
-// =======================================================
-// Analytics helpers: dates, sorting, rolling average
-// =======================================================
-bool parse_date_key(const string &ymd, int &key_out)
+static const StreakRule STREAK_WIN{ StreakRule::WIN };
+static const StreakRule STREAK_LOSS{ StreakRule::LOSS };
+static const StreakRule STREAK_HIGH_KDA{ StreakRule::KDA_AT_LEAST, 2.0 };
+
+// Maximal runs of matching positions in [0, size()), in position order,
+// with a max pyramid over the lengths. A run is stored relative to the one
+// before it (the misses in front of it, then its length) and a Fenwick tree
+// over gap + length gives any run's end in O(log runs), so an erase only
+// touches the run it lands in and at most one neighbour. Runs an erase
+// empties stay behind as zero-width slots until there are enough to compact.
+struct StreakRuns
 {
-    if (ymd.size() != 10 || ymd[4] != '-' || ymd[7] != '-') return false;
-    string ys = ymd.substr(0, 4);
-    string ms = ymd.substr(5, 2);
-    string ds = ymd.substr(8, 2);
-    if (!is_integer(ys) || !is_integer(ms) || !is_integer(ds)) return false;
-    int y = convert_to_integer(ys);
-    int m = convert_to_integer(ms);
-    int d = convert_to_integer(ds);
-    if (y < 1970 || y > 2100) return false;
-    if (m < 1 || m > 12) return false;
-    if (d < 1 || d > 31) return false;
-    key_out = y * 10000 + m * 100 + d;
-    return true;
-}
+    vector<int> gap, len;                  // per slot; both 0 = dead slot
+    MaxPyramid longest;
+    size_t n = 0;                          // positions seen
 
-vector<int> build_sorted_indices_by_date(const Player &p, GameType filter)
-{
-    struct Row { int idx; int date_key; };
-    vector<Row> rows;
-    rows.reserve(p.sessions.size());
+    size_t size() const { return n; }
+    void clear() { gap.clear(); len.clear(); tree.clear(); longest.truncate(0); n = 0; total = 0; last = 0; dead = 0; }
 
-    for (int i = 0; i < (int)p.sessions.size(); ++i)
+    void append(bool hit)
     {
-        if (filter != GameType::Unknown && p.sessions[i].game_type != filter) continue;
-        int key = 0;
-        if (!parse_date_key(p.sessions[i].session_date, key)) key = 99999999;
-        rows.push_back({i, key});
+        if (hit)
+        {
+            if (total > 0 && total == n) { len[last]++; add(last, 1); }
+            else
+            {
+                gap.push_back((int)(n - total)); len.push_back(1);
+                push(gap.back() + 1);
+                last = len.size() - 1;
+            }
+            total = n + 1;
+            longest.raise(last, len[last]);
+        }
+        n++;
     }
 
-    sort(rows.begin(), rows.end(), [](const Row &a, const Row &b){ return a.date_key < b.date_key; });
-
-    vector<int> out; out.reserve(rows.size());
-    for (auto &r : rows) out.push_back(r.idx);
-    return out;
-}
-
-void rolling_average(const vector<double> &v, int window, vector<double> &out)
-{
-    out.assign(v.size(), 0.0);
-    if (window <= 1 || v.empty()) { out = v; return; }
+    int best() const { return longest.top(); }
+    int current() const { return (total > 0 && total == n) ? len[last] : 0; }
 
-    double sum = 0.0;
-    for (size_t i = 0; i < v.size(); ++i)
+    // Longest run inside positions [b, e); runs crossing either edge count
+    // only their inside part
+    int best_in(size_t b, size_t e) const
     {
-        sum += v[i];
-        if (i >= (size_t)window) sum -= v[i - window];
-        size_t denom = (i + 1 < (size_t)window) ? (i + 1) : (size_t)window;
-        out[i] = sum / denom;
+        e = min(e, n);
+        if (b >= e || total <= b) return 0;
+        size_t lo = find(b), hi = find(e - 1);
+        if (hi < len.size() && run_start(hi) < e) hi++;
+        if (lo >= hi) return 0;
+        auto clipped = [&](size_t j)
+        {
+            size_t end = prefix(j + 1), start = end - len[j];
+            return (int)max<ptrdiff_t>(0, (ptrdiff_t)min(end, e) - (ptrdiff_t)max(start, b));
+        };
+        int m = max(clipped(lo), clipped(hi - 1));
+        if (hi - lo > 2) m = max(m, longest.range_max(lo + 1, hi - 1));
+        return m;
     }
-}
-
-// =======================================================
-// Achievements (NEW)
-// =======================================================
-struct AchievementDef
-{
-    string id;
-    string name;
-    string desc;
-};
 
-static vector<AchievementDef> achievement_catalog()
-{
-    return {
-        {"first_match",     "First Blood",        "Save your very first match."},
-        {"ten_matches",     "Warmed Up",          "Reach 10 saved matches."},
-        {"win_streak_5",    "On Fire",            "Get a best win streak of 5 or more."},
-        {"kda_beast_3",     "KDA Beast",          "Hit KDA ≥ 3.0 in any single match."},
-        {"avg_kda_2_last5", "Consistent Threat",  "Average KDA ≥ 2.0 over your last 5 matches."}
-    };
-}
+    // Position `pos` is removed; `hit` is whether it matched
+    void erase(size_t pos, bool hit)
+    {
+        if (pos >= n) return;
+        n--;
+        if (hit)
+        {
+            size_t j = find(pos);
+            len[j]--; add(j, -1); total--;
+            longest.set(j, len[j]);
+            if (len[j] > 0) return;
+            // The run is gone: its misses join the next run's, or the tail
+            int g = gap[j];
+            gap[j] = 0; add(j, -g);
+            size_t next = find(prefix(j));
+            if (next < len.size()) { gap[next] += g; add(next, g); }
+            else { total -= g; if (total > 0) last = find(total - 1); }
+            dead++;
+        }
+        else
+        {
+            if (pos >= total) return;              // a trailing miss
+            size_t j = find(pos);
+            gap[j]--; add(j, -1); total--;
+            size_t before = prefix(j);
+            if (gap[j] > 0 || before == 0) return;
+            // Nothing left between this run and the previous one: merge
+            size_t p = find(before - 1);
+            len[p] += len[j]; add(p, len[j]);
+            add(j, -len[j]); len[j] = 0;
+            longest.set(j, 0); longest.raise(p, len[p]);
+            if (last == j) last = p;
+            dead++;
+        }
+        if (dead > 64 && dead * 2 > len.size()) compact();
+    }
 
-static bool has_id(const vector<string> &ids, const string &id)
-{
-    return find(ids.begin(), ids.end(), id) != ids.end();
-}
+private:
+    vector<int> tree;                      // Fenwick over gap + len, node i at [i - 1]
+    size_t total = 0;                      // end of the last live run
+    size_t last = 0;                       // slot of the last live run when total > 0
+    size_t dead = 0;
 
-static bool check_rule(const Player &p, const string &id)
-{
-    if (id == "first_match") return !p.sessions.empty();
+    void add(size_t k, int d) { for (size_t i = k + 1; i <= tree.size(); i += i & (0 - i)) tree[i - 1] += d; }
 
-    if (id == "ten_matches") return ((int)p.sessions.size() >= 10);
+    // Sum of gap + len over slots [0, k)
+    size_t prefix(size_t k) const
+    {
+        int s = 0;
+        for (size_t i = k; i > 0; i -= i & (0 - i)) s += tree[i - 1];
+        return (size_t)s;
+    }
 
-    if (id == "win_streak_5")
+    void push(int v)
     {
-        SummaryStats st = compute_summary(p);
-        return st.best_win_streak >= 5;
+        size_t i = tree.size() + 1;
+        tree.push_back(v + (int)prefix(i - 1) - (int)prefix(i - (i & (0 - i))));
     }
 
-    if (id == "kda_beast_3")
+    // First slot ending after `pos` (a live one), or the slot count
+    size_t find(size_t pos) const
     {
-        for (const auto &s : p.sessions)
-            if (kda_for(s) >= 3.0) return true;
-        return false;
+        size_t at = 0, step = 1;
+        int rem = (int)pos;
+        while (step * 2 <= tree.size()) step *= 2;
+        for (; step > 0; step /= 2)
+            if (at + step <= tree.size() && tree[at + step - 1] <= rem) { at += step; rem -= tree[at - 1]; }
+        return at;
     }
 
-    if (id == "avg_kda_2_last5")
+    size_t run_start(size_t j) const { return prefix(j + 1) - len[j]; }
+
+    // Drops the dead slots; amortised over the erases that made them
+    void compact()
     {
-        if (p.sessions.empty()) return false;
-        vector<int> idx = build_sorted_indices_by_date(p, GameType::Unknown);
-        int n = (int)idx.size();
-        int start = max(0, n - 5);
-        int sum_k=0, sum_d=0, sum_a=0, cnt=0;
-        for (int i = start; i < n; ++i)
+        size_t k = 0;
+        for (size_t j = 0; j < len.size(); ++j)
+            if (len[j] > 0) { gap[k] = gap[j]; len[k] = len[j]; k++; }
+        gap.resize(k); len.resize(k);
+        tree.assign(len.begin(), len.end());
+        for (size_t i = 1; i <= k; ++i)
         {
-            const auto &s = p.sessions[idx[i]];
-            sum_k += s.kills; sum_d += s.deaths; sum_a += s.assists; cnt++;
+            tree[i - 1] += gap[i - 1];
+            size_t up = i + (i & (0 - i));
+            if (up <= k) tree[up - 1] += tree[i - 1];
         }
-        if (cnt == 0) return false;
-        double avg_d = max(1.0, sum_d / (double)cnt);
-        double avg_k = sum_k / (double)cnt;
-        double avg_a = sum_a / (double)cnt;
-        double kda = (avg_k + avg_a)/avg_d;
-        return kda >= 2.0;
+        longest.truncate(0);
+        for (size_t j = 0; j < k; ++j) longest.raise(j, len[j]);
+        last = k > 0 ? k - 1 : 0;
+        dead = 0;
     }
+};
 
-    return false;
-}
-
-void evaluate_achievements(Player &p, bool notify_new)
+// Streak runs for the rules asked about so far along one ordering; each
+// is extended from where it stopped, so appends cost O(log runs) per rule
+struct StreakCache
 {
-    auto defs = achievement_catalog();
-    vector<string> newly;
+    deque<pair<StreakRule, StreakRuns>> entries;   // deque: returned references stay valid
 
-    for (const auto &d : defs)
+    // at(i) is the row at position i of the ordering, n its length
+    template <typename At>
+    StreakRuns &get(const StreakRule &rule, const SessionColumns &c, size_t n, At at)
     {
-        if (!has_id(p.achievements, d.id) && check_rule(p, d.id))
-        {
-            p.achievements.push_back(d.id);
-            newly.push_back(d.name);
-        }
+        StreakRuns *runs = nullptr;
+        for (auto &e : entries) if (e.first == rule) { runs = &e.second; break; }
+        if (runs == nullptr) { entries.push_back({ rule, StreakRuns{} }); runs = &entries.back().second; }
+        for (size_t i = runs->size(); i < n; ++i) runs->append(rule.test(c, at(i)));
+        return *runs;
     }
 
-    if (notify_new)
+    template <typename At>
+    void extend(const SessionColumns &c, size_t n, At at)
     {
-        for (const auto &nm : newly)
-            draw_toast("Achievement unlocked: " + nm + " 🎉");
+        for (auto &e : entries)
+            for (size_t i = e.second.size(); i < n; ++i) e.second.append(e.first.test(c, at(i)));
     }
-}
 
-void show_achievements_screen(const Player &p)
-{
-    auto defs = achievement_catalog();
+    // Row `pos` of the ordering is about to be removed
+    void erase(const SessionColumns &c, size_t pos, size_t row)
+    {
+        for (auto &e : entries)
+            if (e.second.size() > pos) e.second.erase(pos, e.first.test(c, row));
+    }
 
-    draw_bg_with_dimmer(0.45);
-    draw_hud("Achievements");
+    void reset() { for (auto &e : entries) e.second.clear(); }
+};
 
-    int x = 40, y = 80, h = 64, w = screen_width() - 80;
+// Sums over a run of sessions; differences of two prefix entries give any window
+struct WindowSums
+{
+    long long kills = 0, deaths = 0, assists = 0;
+    int wins = 0, losses = 0;
 
-    for (const auto &d : defs)
+    WindowSums operator-(const WindowSums &o) const
     {
-        bool unlocked = has_id(p.achievements, d.id);
-        draw_card_row(x, y, w, h);
-        string title = (unlocked ? "✓ " : "• ") + d.name;
-        draw_ui_text(title, unlocked ? COL_OK : COL_SUB, x + 16, y + 12, 22);
-        draw_ui_text(d.desc, COL_TEXT, x + 16, y + 36, 16);
-        y += h + 12;
+        return { kills - o.kills, deaths - o.deaths, assists - o.assists, wins - o.wins, losses - o.losses };
     }
+};
+
+// Row indices ordered by (date key, row). Appends in date order are a
+// push_back; anything else lands in an unsorted tail that is sorted and
+// merged in on the next read, so a burst of edits costs one merge.
+// prefix[i] holds the sums of order[0, i); entries past `prefix_valid`
+// are stale and get refilled from the first changed position on demand.
+struct DateIndex
+{
+    vector<int> order;
+    size_t sorted = 0;          // order[0, sorted) is in (date key, row) order
+    vector<WindowSums> prefix;
+    size_t prefix_valid = 0;    // prefix[0, prefix_valid] is up to date
+    StreakCache streaks;        // along `order`; dropped whenever positions move
 
-    draw_ui_text("Press any key to return", COL_SUB, x, y + 8, 16);
-    refresh_screen(60);
+    void append(int row) { order.push_back(row); }
 
-    while (!(key_typed(RETURN_KEY) || key_typed(ESCAPE_KEY) || mouse_clicked(LEFT_BUTTON)
-             || key_typed(SPACE_KEY) || key_typed(A_KEY) || key_typed(B_KEY)))
+    const vector<int> &view(const SessionColumns &c)
     {
-        process_events(); delay(10);
+        if (sorted == order.size()) return order;
+        const vector<int32_t> &key = c.date_key;
+        auto less = [&](int a, int b) { return key[a] != key[b] ? key[a] < key[b] : a < b; };
+        // A tail that is already ordered and starts after the prefix needs no work
+        if (!is_sorted(order.begin() + sorted, order.end(), less))
+            sort(order.begin() + sorted, order.end(), less);
+        if (sorted > 0 && less(order[sorted], order[sorted - 1]))
+        {
+            size_t first = upper_bound(order.begin(), order.begin() + sorted, order[sorted], less) - order.begin();
+            prefix_valid = min(prefix_valid, first);
+            streaks.reset();
+            inplace_merge(order.begin(), order.begin() + sorted, order.end(), less);
+        }
+        sorted = order.size();
+        return order;
     }
-}
 
-// =======================================================
-// JSON helpers (writer + focused parser for our schema)
-// =======================================================
-static string json_escape(const string &s)
-{
-    string out; out.reserve(s.size() + 8);
-    for (char c : s)
+    // Sums of order[b, e) in O(1) once the prefix is current
+    WindowSums sums(const SessionColumns &c, size_t b, size_t e)
     {
-        switch (c)
+        view(c);
+        prefix.resize(order.size() + 1);
+        for (size_t i = prefix_valid; i < order.size(); ++i)
         {
-            case '\"': out += "\\\""; break;
-            case '\\': out += "\\\\"; break;
-            case '\b': out += "\\b";  break;
-            case '\f': out += "\\f";  break;
-            case '\n': out += "\\n";  break;
-            case '\r': out += "\\r";  break;
-            case '\t': out += "\\t";  break;
-            default:
-                if ((unsigned char)c < 0x20) {
-                    char buf[7]; snprintf(buf, sizeof(buf), "\\u%04x", (unsigned char)c);
-                    out += buf;
-                } else out += c;
+            int r = order[i];
+            WindowSums s = prefix[i];
+            s.kills += c.kills[r]; s.deaths += c.deaths[r]; s.assists += c.assists[r];
+            s.wins += (c.outcome[r] == OUTCOME_WIN);
+            s.losses += (c.outcome[r] == OUTCOME_LOSS);
+            prefix[i + 1] = s;
         }
+        prefix_valid = order.size();
+        return prefix[e] - prefix[b];
     }
-    return out;
-}
-
-static void skip_ws(const string &s, size_t &i)
-{
-    while (i < s.size() && (s[i] == ' ' || s[i] == '\n' || s[i] == '\t' || s[i] == '\r')) i++;
-}
-
-static bool match_char(const string &s, size_t &i, char want)
-{
-    skip_ws(s, i);
-    if (i < s.size() && s[i] == want) { i++; return true; }
-    return false;
-}
 
-static bool parse_string_quoted(const string &s, size_t &i, string &out)
-{
-    skip_ws(s, i);
-    if (i >= s.size() || s[i] != '\"') return false;
-    i++;
-    string res;
-    while (i < s.size())
+    // Drops `row` and renumbers the rows after it; relative order is kept
+    void erase(int row)
     {
-        char c = s[i++];
-        if (c == '\"') { out = res; return true; }
-        if (c == '\\')
+        size_t out = 0, new_sorted = sorted;
+        for (size_t i = 0; i < order.size(); ++i)
         {
-            if (i >= s.size()) return false;
-            char e = s[i++];
-            switch (e)
+            int r = order[i];
+            if (r == row)
             {
-                case '\"': res += '\"'; break;
-                case '\\': res += '\\'; break;
-                case '/':  res += '/';  break;
-                case 'b':  res += '\b'; break;
-                case 'f':  res += '\f'; break;
-                case 'n':  res += '\n'; break;
-                case 'r':  res += '\r'; break;
-                case 't':  res += '\t'; break;
-                case 'u':
-                {
-                    if (i + 4 > s.size()) return false;
-                    for (int k = 0; k < 4; ++k)
-                    {
-                        char h = s[i++];
-                        if (!isxdigit((unsigned char)h)) return false;
-                    }
-                    res += '?'; // skip unicode -> placeholder
-                    break;
-                }
-                default: return false;
+                if (i < sorted) new_sorted--;
+                prefix_valid = min(prefix_valid, i);
+                continue;
             }
+            order[out++] = (r > row) ? r - 1 : r;
         }
-        else res += c;
+        order.resize(out);
+        sorted = new_sorted;
+        prefix_valid = min(prefix_valid, order.size());
+        streaks.reset();
     }
-    return false;
-}
 
-static bool parse_integer(const string &s, size_t &i, long long &out)
+    void clear() { order.clear(); sorted = 0; prefix.clear(); prefix_valid = 0; streaks.reset(); }
+};
+
+// Running lifetime totals, kept in step with every insert/erase so the
+// summary never needs a full pass over the sessions.
+struct SessionTotals
 {
-    skip_ws(s, i);
-    if (i >= s.size()) return false;
-    bool neg = false;
-    if (s[i] == '-') { neg = true; i++; }
-    if (i >= s.size() || !isdigit((unsigned char)s[i])) return false;
-    long long v = 0;
-    while (i < s.size() && isdigit((unsigned char)s[i])) { v = v * 10 + (s[i] - '0'); i++; }
-    out = neg ? -v : v; return true;
-}
+    long long kills = 0, deaths = 0, assists = 0;
+    int wins = 0, losses = 0;
+};
 
-static bool parse_literal(const string &s, size_t &i, const char *lit)
+// Rows in fixed-size chunks shared between copies: copying the container
+// copies chunk pointers, and a chunk is cloned the first time it is written
+// while another copy still holds it. This is what makes a save snapshot cheap.
+struct SharedRows
 {
-    skip_ws(s, i);
-    size_t start = i;
-    for (const char *p = lit; *p; ++p)
+    static const size_t CHUNK = 4096;
+
+    struct const_iterator
+    {
+        const SharedRows *r; size_t i;
+        const Session &operator*() const { return (*r)[i]; }
+        const_iterator &operator++() { ++i; return *this; }
+        bool operator!=(const const_iterator &o) const { return i != o.i; }
+    };
+
+    size_t size() const { return n; }
+    bool empty() const { return n == 0; }
+    const Session &operator[](size_t i) const { return (*chunks[i / CHUNK])[i % CHUNK]; }
+    const_iterator begin() const { return { this, 0 }; }
+    const_iterator end() const { return { this, n }; }
+
+    void reserve(size_t rows) { chunks.reserve(rows / CHUNK + 1); }
+    void clear() { chunks.clear(); n = 0; }
+
+    void push_back(Session &&s)
     {
-        if (i >= s.size() || s[i] != *p) { i = start; return false; }
-        i++;
+        if (n % CHUNK == 0)
+        {
+            chunks.push_back(make_shared<vector<Session>>());
+            chunks.back()->reserve(CHUNK);
+        }
+        own(chunks.size() - 1).push_back(std::move(s));
+        n++;
     }
-    return true;
-}
 
-static bool skip_value(const string &s, size_t &i); // fwd
-static bool skip_array(const string &s, size_t &i)
-{
-    if (!match_char(s, i, '[')) return false;
-    skip_ws(s, i);
-    if (match_char(s, i, ']')) return true;
-    while (true)
+    Session &back() { return own(chunks.size() - 1).back(); }
+
+    void pop_back()
     {
-        if (!skip_value(s, i)) return false;
-        skip_ws(s, i);
-        if (match_char(s, i, ']')) return true;
-        if (!match_char(s, i, ',')) return false;
+        own(chunks.size() - 1).pop_back();
+        if (--n % CHUNK == 0) chunks.pop_back();
     }
-}
-static bool skip_object(const string &s, size_t &i)
-{
-    if (!match_char(s, i, '{')) return false;
-    skip_ws(s, i);
-    if (match_char(s, i, '}')) return true;
-    while (true)
+
+    // Shifts every later row down one, across chunk boundaries
+    void erase(size_t i)
     {
-        string k;
-        if (!parse_string_quoted(s, i, k)) return false;
-        if (!match_char(s, i, ':')) return false;
-        if (!skip_value(s, i)) return false;
-        skip_ws(s, i);
-        if (match_char(s, i, '}')) return true;
-        if (!match_char(s, i, ',')) return false;
+        size_t c = i / CHUNK;
+        vector<Session> &first = own(c);
+        first.erase(first.begin() + (ptrdiff_t)(i % CHUNK));
+        for (size_t k = c + 1; k < chunks.size(); ++k)
+        {
+            vector<Session> &next = own(k);
+            own(k - 1).push_back(std::move(next.front()));
+            next.erase(next.begin());
+        }
+        if (--n % CHUNK == 0) chunks.pop_back();
     }
-}
-static bool skip_value(const string &s, size_t &i)
+
+private:
+    vector<Session> &own(size_t k)
+    {
+        if (chunks[k].use_count() > 1)
+        {
+            auto copy = make_shared<vector<Session>>();
+            copy->reserve(CHUNK);
+            copy->assign(chunks[k]->begin(), chunks[k]->end());
+            chunks[k] = std::move(copy);
+        }
+        // use_count is a relaxed load. A snapshot released on the save
+        // worker drops its count with a release decrement; this fence pairs
+        // with it, so the worker's reads of the chunk happen before our writes.
+        else atomic_thread_fence(memory_order_acquire);
+        return *chunks[k];
+    }
+
+    vector<shared_ptr<vector<Session>>> chunks;
+    size_t n = 0;
+};
+
+// A binary snapshot's string table as SessionStore::push_back_ids reads it:
+// each snapshot id is resolved against the store the first time a row uses
+// it, after that a row's strings cost array reads instead of hashing
+struct SnapshotStrings
 {
-    skip_ws(s, i);
-    if (i >= s.size()) return false;
-    char c = s[i];
-    if (c == '\"') { string dummy; return parse_string_quoted(s, i, dummy); }
-    if (c == '{') return skip_object(s, i);
-    if (c == '[') return skip_array(s, i);
-    if (c == 't') return parse_literal(s, i, "true");
-    if (c == 'f') return parse_literal(s, i, "false");
-    if (c == 'n') return parse_literal(s, i, "null");
-    if (c == '-' || isdigit((unsigned char)c)) { long long num; return parse_integer(s, i, num); }
-    return false;
-}
+    static const uint32_t UNSEEN = 0xFFFFFFFFu;
 
-// Parse array of sessions
-static bool parse_sessions_array(const string &s, size_t &i, Player &p)
+    vector<string_view> texts;         // by snapshot id
+    vector<uint32_t> game, rank;       // store table ids, UNSEEN until first use
+    vector<uint8_t> outcome;           // Outcome, 0xFF until first use
+
+    explicit SnapshotStrings(vector<string_view> t)
+        : texts(std::move(t)), game(texts.size(), UNSEEN), rank(texts.size(), UNSEEN), outcome(texts.size(), 0xFF) {}
+};
+
+struct SessionStore
 {
-    if (!match_char(s, i, '[')) return false;
-    skip_ws(s, i);
-    if (match_char(s, i, ']')) return true;
+    size_t size() const { return rows.size(); }
+    bool empty() const { return rows.empty(); }
+    const Session &operator[](size_t i) const { return rows[i]; }
+    SharedRows::const_iterator begin() const { return rows.begin(); }
+    SharedRows::const_iterator end() const { return rows.end(); }
 
-    while (true)
+    const SessionColumns &columns() const { return cols; }
+
+    // Date key as produced by parse_date_key (99999999 when unparseable)
+    int date_key(size_t i) const { return cols.date_key[i]; }
+
+    void reserve(size_t n)
     {
-        if (!match_char(s, i, '{')) return false;
-        Session temp{}; bool has_game_type=false, has_k=false, has_d=false, has_a=false;
+        rows.reserve(n); cols.reserve(n);
+        dated[(size_t)GameType::Unknown].order.reserve(n);  // the per-game orders split n; they grow
+    }
+    void clear()
+    {
+        rows.clear(); cols.clear(); game_names.clear(); ranks.clear(); rank_ords.clear();
+        sums = SessionTotals{};
+        row_streaks.reset();
+        for (DateIndex &d : dated) d.clear();
+        edits++;
+    }
+
+    // Rows of one game (GameType::Unknown = all games) oldest first; ties
+    // keep insertion order. Maintained on insert/erase, never rebuilt.
+    const vector<int> &by_date(GameType filter) const { return dated[(size_t)filter].view(cols); }
+
+    // Sums over positions [b, e) of by_date(filter), O(1) after the first call
+    // following an edit
+    WindowSums window_sums(GameType filter, size_t b, size_t e) const { return dated[(size_t)filter].sums(cols, b, e); }
+
+    // Runs of `rule` in insertion order (the lifetime streaks). The standard
+    // win/loss/KDA >= 2 rules are kept current on every insert/erase; any
+    // other rule is built on first use and extended after that.
+    const StreakRuns &streaks(const StreakRule &rule) const
+    {
+        return row_streaks.get(rule, cols, cols.size(), [](size_t i) { return i; });
+    }
+
+    // Runs of `rule` along by_date(filter); rebuilt after an edit that moves
+    // positions, extended on in-order appends
+    const StreakRuns &streaks_by_date(GameType filter, const StreakRule &rule) const
+    {
+        const vector<int> &o = by_date(filter);
+        return dated[(size_t)filter].streaks.get(rule, cols, o.size(), [&](size_t i) { return (size_t)o[i]; });
+    }
+
+    // Positions [b, e) of by_date(filter) whose date key is within [from_key, to_key]
+    pair<size_t, size_t> date_range(GameType filter, int from_key, int to_key) const
+    {
+        const vector<int> &o = by_date(filter);
+        auto b = lower_bound(o.begin(), o.end(), from_key, [&](int r, int k) { return cols.date_key[r] < k; });
+        auto e = upper_bound(b, o.end(), to_key, [&](int k, int r) { return k < cols.date_key[r]; });
+        return { (size_t)(b - o.begin()), (size_t)(e - o.begin()) };
+    }
+
+    const SessionTotals &totals() const { return sums; }
+
+    // Bumped by every insert/erase/clear; views compare it to spot stale caches
+    uint64_t version() const { return edits; }
+
+    // Distinct game_name texts; SessionColumns::game_id indexes this
+    const StringTable &games() const { return game_names; }
+
+    // What the snapshot writers read: the rows (shared, not copied) and their
+    // date keys. Totals, indexes and the other columns are left empty, so
+    // only size(), operator[] and date_key() are valid on the result.
+    SessionStore snapshot() const
+    {
+        SessionStore out;
+        out.rows = rows;
+        out.cols.date_key = cols.date_key;
+        return out;
+    }
+
+    // Every session enters through here, so game_type is always canonical
+    void push_back(Session s)
+    {
+        s.game_type = normalized_game_type(s.game_type, s.game_name);
+        int key = 0;
+        if (!parse_date_key(s.session_date, key)) key = 99999999;
+        index_row(s, key);
+        rows.push_back(std::move(s));
+    }
+
+    // Bulk path for a binary snapshot: numbers and game_type go into the
+    // columns as stored and the strings arrive as snapshot ids, so neither
+    // the outcome nor the rank ladder is parsed per row. The Session still
+    // gets its text (the views read it). False if an id is out of range.
+    bool push_back_ids(SnapshotStrings &ss, int kills, int deaths, int assists, int key, GameType g,
+                       uint32_t game, uint32_t rank, uint32_t outcome, string &&date)
+    {
+        size_t n = ss.texts.size();
+        if (game >= n || rank >= n || outcome >= n) return false;
+        if (ss.game[game] == SnapshotStrings::UNSEEN) ss.game[game] = game_names.intern(ss.texts[game]);
+        if (ss.rank[rank] == SnapshotStrings::UNSEEN) ss.rank[rank] = ranks.intern(ss.texts[rank]);
+        if (ss.outcome[outcome] == 0xFF) ss.outcome[outcome] = parse_outcome_id(ss.texts[outcome]);
+
+        cols.push(kills, deaths, assists, key, (Outcome)ss.outcome[outcome], g, ss.game[game], rank_ord_of(ss.rank[rank], g));
+        place_row(g);
+
+        Session s;
+        s.game_name = game_names.text(ss.game[game]);
+        s.game_type = g;
+        s.kills = kills; s.deaths = deaths; s.assists = assists;
+        s.rank = ranks.text(ss.rank[rank]);
+        s.outcome.assign(ss.texts[outcome]);
+        s.session_date = std::move(date);
+        rows.push_back(std::move(s));
+        return true;
+    }
+
+    // Builds the row in place; `fill` returning false discards it
+    template <typename F>
+    bool append_with(F fill)
+    {
+        rows.push_back(Session{});
+        if (!fill(rows.back())) { rows.pop_back(); return false; }
+        Session &s = rows.back();
+        s.game_type = normalized_game_type(s.game_type, s.game_name);
+        int key = 0;
+        if (!parse_date_key(s.session_date, key)) key = 99999999;
+        index_row(s, key);
+        return true;
+    }
+
+    void erase(size_t i)
+    {
+        if (i >= rows.size()) return;
+        untally(i);
+        row_streaks.erase(cols, i, i);
+        for (DateIndex &d : dated) d.erase((int)i);   // every index renumbers the rows after i
+        rows.erase(i);
+        cols.erase(i);
+        edits++;
+    }
+
+private:
+    // Interns the row's strings and appends its column entry. Rank ordinals
+    // are resolved once per distinct (rank text, game) pair.
+    void index_row(const Session &s, int key)
+    {
+        uint32_t game = game_names.intern(s.game_name);
+        uint32_t rank = ranks.intern(s.rank);
+        cols.push(s, key, game, rank_ord_of(rank, s.game_type));
+        place_row(s.game_type);
+    }
+
+    int rank_ord_of(uint32_t rank, GameType g)
+    {
+        size_t slot = (size_t)rank * 3 + (size_t)g;
+        if (rank_ords.size() <= slot) rank_ords.resize(((size_t)rank + 1) * 3, -1);
+        if (rank_ords[slot] < 0) rank_ords[slot] = (int16_t)rank_ordinal(g, ranks.text(rank));
+        return rank_ords[slot];
+    }
+
+    // Totals and date indexes for the row just pushed onto the columns
+    void place_row(GameType g)
+    {
+        tally(cols.size() - 1);
+        int row = (int)cols.size() - 1;
+        dated[(size_t)GameType::Unknown].append(row);
+        if (g != GameType::Unknown) dated[(size_t)g].append(row);
+        edits++;
+    }
+
+    void tally(size_t i)
+    {
+        sums.kills += cols.kills[i]; sums.deaths += cols.deaths[i]; sums.assists += cols.assists[i];
+        sums.wins   += (cols.outcome[i] == OUTCOME_WIN);
+        sums.losses += (cols.outcome[i] == OUTCOME_LOSS);
+        row_streaks.extend(cols, i + 1, [](size_t r) { return r; });
+    }
+
+    // Inverse of tally's sums for a row about to be erased
+    void untally(size_t i)
+    {
+        sums.kills -= cols.kills[i]; sums.deaths -= cols.deaths[i]; sums.assists -= cols.assists[i];
+        sums.wins   -= (cols.outcome[i] == OUTCOME_WIN);
+        sums.losses -= (cols.outcome[i] == OUTCOME_LOSS);
+    }
+
+    static StreakCache standard_streaks()
+    {
+        StreakCache c;
+        for (const StreakRule &r : { STREAK_WIN, STREAK_LOSS, STREAK_HIGH_KDA }) c.entries.push_back({ r, StreakRuns{} });
+        return c;
+    }
+
+    SharedRows rows;
+    SessionColumns cols;
+    StringTable game_names, ranks;
+    vector<int16_t> rank_ords;         // [rank id * 3 + GameType], -1 = not yet resolved
+    SessionTotals sums;
+    mutable StreakCache row_streaks = standard_streaks();
+    mutable DateIndex dated[3];        // [GameType]; Unknown holds every row
+    uint64_t edits = 0;
+};
+
+// Per-player view of the compiled achievement catalog (see AchievementEngine)
+struct AchievementState
+{
+    vector<uint64_t> unlocked;         // bit per catalog rule
+    vector<double> slot_value;         // last value seen per stat slot (NaN = never)
+    vector<uint32_t> slot_done;        // leading rules of each slot known to be unlocked
+    size_t synced = 0;                 // Player::achievements entries folded into `unlocked`
+
+    bool has(size_t rule) const { return rule / 64 < unlocked.size() && (unlocked[rule / 64] >> (rule % 64) & 1); }
+    void set(size_t rule) { unlocked[rule / 64] |= 1ull << (rule % 64); }
+};
+
+struct Player
+{
+    string player_name;
+    string preferred_game;
+    SessionStore sessions;             // no cap; see SessionStore
+    vector<string> achievements;       // ids of unlocked achievements, in unlock order (saved)
+    AchievementState achievement_state;  // bitset + evaluation cache (not saved)
+
+    uint64_t generation = 0;           // snapshot generation; journal sections older than this are stale
+    int journal_records = 0;           // records appended since the last snapshot (not saved)
+    uint64_t journal_gen = ~0ull;      // generation of the journal section last opened (not saved)
+};
+
+// =======================================================
+// Input with exceptions
+// =======================================================
+int parse_int_in_range(const string &prompt, int lo, int hi)
+{
+    string s = prompt_line(prompt);
+    if (s == "") throw runtime_error("No input provided.");
+    if (!is_integer(s)) throw runtime_error("Please enter a valid integer.");
+    int v = convert_to_integer(s);
+    if (v < lo || v > hi) throw runtime_error("Value must be between " + to_string(lo) + " and " + to_string(hi) + ".");
+    return v;
+}
+
+string parse_nonempty(const string &prompt)
+{
+    string s = prompt_line(prompt);
+    if (s == "") throw runtime_error("Input cannot be empty.");
+    return s;
+}
+
+GameType parse_game_with_name(string &out_name)
+{
+    string s = prompt_line("Game (Valorant / CS:GO):");
+    if (s == "") throw runtime_error("Input cannot be empty.");
+    GameType g = parse_game_type(s);
+    if (g == GameType::Unknown) throw runtime_error("Unsupported game. Enter Valorant or CS:GO.");
+    out_name = game_type_to_string(g);
+    return g;
+}
+
+string parse_outcome()
+{
+    string s = prompt_line("Match outcome (Win/Loss):");
+    if (s == "") throw runtime_error("Input cannot be empty.");
+    string tl = to_lowercase(s);
+    if (tl == "win") return "Win";
+    if (tl == "loss") return "Loss";
+    throw runtime_error("Outcome must be Win or Loss.");
+}
+
+template <typename F>
+auto prompt_until_ok(F fn) -> decltype(fn())
+{
+    while (true)
+    {
+        try { return fn(); }
+        catch (const exception &e) { draw_toast(string("Invalid input: ") + e.what()); }
+    }
+}
+
+// =======================================================
+// Aggregation kernels over SessionColumns (AVX2, picked at startup)
+// =======================================================
+// One pass over rows [begin, end): sums, win/loss counts, the number of
+// matches with KDA >= threshold and, if kda_out is given, each match's KDA
+// (kda_out[0] is row `begin`). Every variant produces bit-identical results:
+// KDA is the same IEEE double division as kda_at and sums are 64-bit.
+struct KdaAggregate
+{
+    long long kills = 0, deaths = 0, assists = 0;
+    int wins = 0, losses = 0;
+    int at_or_above = 0;
+};
+
+static void aggregate_scalar(const SessionColumns &c, size_t begin, size_t end, double threshold,
+                             double *kda_out, KdaAggregate &agg)
+{
+    for (size_t i = begin; i < end; ++i)
+    {
+        agg.kills += c.kills[i]; agg.deaths += c.deaths[i]; agg.assists += c.assists[i];
+        agg.wins   += (c.outcome[i] == OUTCOME_WIN);
+        agg.losses += (c.outcome[i] == OUTCOME_LOSS);
+        double k = kda_at(c, i);
+        agg.at_or_above += (k >= threshold);
+        if (kda_out != nullptr) kda_out[i - begin] = k;
+    }
+}
+
+#ifdef FPSHD_SIMD_X86
+__attribute__((target("avx2")))
+static inline __m256i widen_add_epi64(__m256i acc, __m256i v32)
+{
+    acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v32)));
+    return _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v32, 1)));
+}
+
+__attribute__((target("avx2")))
+static long long hsum_epi64(__m256i v)
+{
+    alignas(32) long long t[4];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(t), v);
+    return t[0] + t[1] + t[2] + t[3];
+}
+
+__attribute__((target("avx2,popcnt")))
+static void aggregate_avx2(const SessionColumns &c, size_t begin, size_t end, double threshold,
+                           double *kda_out, KdaAggregate &agg)
+{
+    const int32_t *K = c.kills.data(), *D = c.deaths.data(), *A = c.assists.data();
+    const uint8_t *O = c.outcome.data();
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m128i win = _mm_set1_epi8((char)OUTCOME_WIN), loss = _mm_set1_epi8((char)OUTCOME_LOSS);
+    const __m256d thr = _mm256_set1_pd(threshold);
+    __m256i sk = _mm256_setzero_si256(), sd = sk, sa = sk;
+    int wins = 0, losses = 0, above = 0;
+
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(K + i));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(D + i));
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(A + i));
+        sk = widen_add_epi64(sk, k); sd = widen_add_epi64(sd, d); sa = widen_add_epi64(sa, a);
+
+        __m128i o = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(O + i));
+        wins   += __builtin_popcount((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(o, win)) & 0xFFu);
+        losses += __builtin_popcount((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(o, loss)) & 0xFFu);
+
+        __m256i num = _mm256_add_epi32(k, a);
+        __m256i den = _mm256_max_epi32(d, one); // deaths <= 0 counts as 1
+        __m256d lo = _mm256_div_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(num)), _mm256_cvtepi32_pd(_mm256_castsi256_si128(den)));
+        __m256d hi = _mm256_div_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(num, 1)), _mm256_cvtepi32_pd(_mm256_extracti128_si256(den, 1)));
+        above += __builtin_popcount((unsigned)_mm256_movemask_pd(_mm256_cmp_pd(lo, thr, _CMP_GE_OQ)));
+        above += __builtin_popcount((unsigned)_mm256_movemask_pd(_mm256_cmp_pd(hi, thr, _CMP_GE_OQ)));
+        if (kda_out != nullptr)
+        {
+            _mm256_storeu_pd(kda_out + (i - begin), lo);
+            _mm256_storeu_pd(kda_out + (i - begin) + 4, hi);
+        }
+    }
+
+    agg.kills += hsum_epi64(sk); agg.deaths += hsum_epi64(sd); agg.assists += hsum_epi64(sa);
+    agg.wins += wins; agg.losses += losses; agg.at_or_above += above;
+    aggregate_scalar(c, i, end, threshold, kda_out != nullptr ? kda_out + (i - begin) : nullptr, agg);
+}
+#endif
+
+struct AggregateKernel
+{
+    const char *name;
+    void (*run)(const SessionColumns &, size_t, size_t, double, double *, KdaAggregate &);
+};
+
+static AggregateKernel pick_aggregate_kernel()
+{
+#ifdef FPSHD_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) return { "avx2", aggregate_avx2 };
+#endif
+    return { "scalar", aggregate_scalar };
+}
+
+static AggregateKernel g_aggregate = pick_aggregate_kernel();
+
+// Rows per kernel call when the caller also needs each match's KDA
+static const size_t AGG_BLOCK = 4096;
+
+// =======================================================
+// Stats (lifetime)
+// =======================================================
+struct SummaryStats
+{
+    int total_matches = 0;
+    int wins = 0;
+    int losses = 0;
+    double avg_kda = 0.0;
+    double win_rate_percent = 0.0;
+
+    int best_win_streak = 0;
+    int best_loss_streak = 0;
+    int best_high_kda_streak = 0;
+};
+
+static void finish_summary(SummaryStats &st, long long kills, long long deaths, long long assists)
+{
+    double avg_deaths  = st.total_matches ? deaths / (double)st.total_matches : 1.0;
+    if (avg_deaths <= 0) avg_deaths = 1.0;
+    double avg_kills   = st.total_matches ? kills  / (double)st.total_matches : 0.0;
+    double avg_assists = st.total_matches ? assists/ (double)st.total_matches : 0.0;
+
+    st.avg_kda = (avg_kills + avg_assists) / avg_deaths;
+    st.win_rate_percent = st.total_matches ? (st.wins * 100.0 / st.total_matches) : 0.0;
+}
+
+// Read from the totals SessionStore maintains on every insert/erase
+SummaryStats compute_summary(const Player &p)
+{
+    const SessionTotals &t = p.sessions.totals();
+    SummaryStats st{};
+    st.total_matches = (int)p.sessions.size();
+    st.wins = t.wins;
+    st.losses = t.losses;
+    st.best_win_streak = p.sessions.streaks(STREAK_WIN).best();
+    st.best_loss_streak = p.sessions.streaks(STREAK_LOSS).best();
+    st.best_high_kda_streak = p.sessions.streaks(STREAK_HIGH_KDA).best();
+    finish_summary(st, t.kills, t.deaths, t.assists);
+    return st;
+}
+
+// Full pass over the columns; the reference the cached summary is checked against
+SummaryStats recompute_summary(const Player &p)
+{
+    SummaryStats st{};
+    const SessionColumns &c = p.sessions.columns();
+    const size_t n = c.size();
+    st.total_matches = (int)n;
+    int cur_win_streak = 0, cur_loss_streak = 0, cur_high_kda_streak = 0;
+
+    // Sums, counts and per-match KDA come from the kernel a block at a time;
+    // only the streak bookkeeping stays a scalar walk over the block.
+    KdaAggregate agg;
+    double kda[AGG_BLOCK];
+    for (size_t b = 0; b < n; b += AGG_BLOCK)
+    {
+        size_t e = min(n, b + AGG_BLOCK);
+        g_aggregate.run(c, b, e, 2.0, kda, agg);
+
+        for (size_t i = b; i < e; ++i)
+        {
+            if (c.outcome[i] == OUTCOME_WIN)
+            {
+                cur_win_streak++; st.best_win_streak = max(st.best_win_streak, cur_win_streak);
+                cur_loss_streak = 0;
+            }
+            else if (c.outcome[i] == OUTCOME_LOSS)
+            {
+                cur_loss_streak++; st.best_loss_streak = max(st.best_loss_streak, cur_loss_streak);
+                cur_win_streak = 0;
+            }
+            else { cur_win_streak = cur_loss_streak = 0; }
+
+            if (kda[i - b] >= 2.0) { cur_high_kda_streak++; st.best_high_kda_streak = max(st.best_high_kda_streak, cur_high_kda_streak); }
+            else cur_high_kda_streak = 0;
+        }
+    }
+    st.wins = agg.wins;
+    st.losses = agg.losses;
+    finish_summary(st, agg.kills, agg.deaths, agg.assists);
+    return st;
+}
+
+int find_best_session_by_kda(const Player &p)
+{
+    const SessionColumns &c = p.sessions.columns();
+    if (c.size() == 0) return -1;
+    double best = -1.0; int idx = -1;
+    for (size_t i = 0; i < c.size(); ++i)
+    {
+        double k = kda_at(c, i);
+        if (k > best) { best = k; idx = (int)i; }
+    }
+    return idx;
+}
+
+// =======================================================
+// Analytics helpers: dates, sorting, rolling average
+// =======================================================
+// Session indices for one game (Unknown = all), oldest first. Reads the
+// store's persistent index; valid until the next insert/erase.
+const vector<int> &sessions_by_date(const Player &p, GameType filter)
+{
+    return p.sessions.by_date(filter);
+}
+
+void rolling_average(const vector<double> &v, int window, vector<double> &out)
+{
+    out.assign(v.size(), 0.0);
+    if (window <= 1 || v.empty()) { out = v; return; }
+
+    double sum = 0.0;
+    for (size_t i = 0; i < v.size(); ++i)
+    {
+        sum += v[i];
+        if (i >= (size_t)window) sum -= v[i - window];
+        size_t denom = (i + 1 < (size_t)window) ? (i + 1) : (size_t)window;
+        out[i] = sum / denom;
+    }
+}
+
+// Min/max (and optionally sum) pyramid over one series: level 0 is the
+// series, level k+1 folds pairs of level k, so block j of level k covers
+// [j * 2^k, (j + 1) * 2^k). Any range decomposes into O(log n) blocks.
+struct RangePyramid
+{
+    vector<vector<double>> lo, hi, sum;
+
+    size_t size() const { return lo.empty() ? 0 : lo[0].size(); }
+
+    void build(const vector<double> &v, bool with_sum = false)
+    {
+        lo.assign(1, v); hi.assign(1, v);
+        sum.clear();
+        if (with_sum) sum.assign(1, v);
+        while (lo.back().size() > 1)
+        {
+            const size_t m = (lo.back().size() + 1) / 2;
+            vector<double> l(m), h(m), s(with_sum ? m : 0);
+            const vector<double> &pl = lo.back(), &ph = hi.back();
+            for (size_t j = 0; j < m; ++j)
+            {
+                size_t a = 2 * j, b = min(2 * j + 1, pl.size() - 1);
+                l[j] = min(pl[a], pl[b]);
+                h[j] = max(ph[a], ph[b]);
+                if (with_sum) s[j] = sum.back()[a] + (b != a ? sum.back()[b] : 0.0);
+            }
+            lo.push_back(std::move(l)); hi.push_back(std::move(h));
+            if (with_sum) sum.push_back(std::move(s));
+        }
+    }
+
+    // Min/max (and sum if built with one) over [b, e); b < e <= size()
+    void range(size_t b, size_t e, double &mn, double &mx, double *total = nullptr) const
+    {
+        mn = INFINITY; mx = -INFINITY;
+        double t = 0.0;
+        for (size_t k = 0; b < e; ++k, b >>= 1, e >>= 1)
+        {
+            if (b & 1) { mn = min(mn, lo[k][b]); mx = max(mx, hi[k][b]); if (total) t += sum[k][b]; ++b; }
+            if (e & 1) { --e; mn = min(mn, lo[k][e]); mx = max(mx, hi[k][e]); if (total) t += sum[k][e]; }
+        }
+        if (total) *total = t;
+    }
+};
+
+// =======================================================
+// Achievements (NEW)
+// =======================================================
+// Rules are data: each one is "stat >= threshold" for a stat the session
+// store keeps incrementally. At startup they are compiled into slots (one
+// per distinct stat) with the rules of a slot sorted by threshold, so an
+// evaluation reads each slot once and unlocks a prefix of its rules.
+enum class AchMetric : uint8_t
+{
+    MATCHES,            // total matches
+    WINS,               // total wins
+    BEST_STREAK,        // longest run of `streak` in insertion order
+    AVG_KDA_LAST_N,     // KDA of the summed last `n` matches by date
+};
+
+struct AchievementDef
+{
+    const char *id;
+    const char *name;
+    const char *desc;
+    AchMetric metric;
+    double at_least;
+    StreakRule streak;  // BEST_STREAK only
+    int n;              // AVG_KDA_LAST_N only
+};
+
+static const AchievementDef ACHIEVEMENT_CATALOG[] = {
+    {"first_match",     "First Blood",        "Save your very first match.",                  AchMetric::MATCHES,        1,   {}, 0},
+    {"ten_matches",     "Warmed Up",          "Reach 10 saved matches.",                      AchMetric::MATCHES,        10,  {}, 0},
+    {"win_streak_5",    "On Fire",            "Get a best win streak of 5 or more.",          AchMetric::BEST_STREAK,    5,   STREAK_WIN, 0},
+    {"kda_beast_3",     "KDA Beast",          "Hit KDA ≥ 3.0 in any single match.",           AchMetric::BEST_STREAK,    1,   { StreakRule::KDA_AT_LEAST, 3.0 }, 0},
+    {"avg_kda_2_last5", "Consistent Threat",  "Average KDA ≥ 2.0 over your last 5 matches.",  AchMetric::AVG_KDA_LAST_N, 2.0, {}, 5},
+};
+
+struct AchievementEngine
+{
+    struct Slot
+    {
+        AchMetric metric;
+        StreakRule streak;
+        int n;
+        vector<uint32_t> rules;        // catalog indices, ascending threshold
+    };
+
+    const AchievementDef *defs = nullptr;
+    size_t count = 0;
+    vector<Slot> slots;
+    unordered_map<string_view, uint32_t> by_id;
+
+    AchievementEngine(const AchievementDef *d, size_t n) : defs(d), count(n)
+    {
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            by_id.emplace(d[i].id, i);
+            auto same = [&](const Slot &s)
+            {
+                return s.metric == d[i].metric && s.streak == d[i].streak && s.n == d[i].n;
+            };
+            auto it = find_if(slots.begin(), slots.end(), same);
+            if (it == slots.end()) { slots.push_back({ d[i].metric, d[i].streak, d[i].n, {} }); it = slots.end() - 1; }
+            it->rules.push_back(i);
+        }
+        for (Slot &s : slots)
+            stable_sort(s.rules.begin(), s.rules.end(), [&](uint32_t a, uint32_t b) { return d[a].at_least < d[b].at_least; });
+    }
+
+    double value(const Slot &s, const Player &p) const
+    {
+        switch (s.metric)
+        {
+            case AchMetric::MATCHES:     return (double)p.sessions.size();
+            case AchMetric::WINS:        return (double)p.sessions.totals().wins;
+            case AchMetric::BEST_STREAK: return (double)p.sessions.streaks(s.streak).best();
+            case AchMetric::AVG_KDA_LAST_N:
+            {
+                size_t total = p.sessions.size();
+                if (total == 0) return -INFINITY;
+                size_t start = total > (size_t)s.n ? total - (size_t)s.n : 0;
+                WindowSums w = p.sessions.window_sums(GameType::Unknown, start, total);
+                double cnt = (double)(total - start);
+                return (w.kills / cnt + w.assists / cnt) / max(1.0, w.deaths / cnt);
+            }
+        }
+        return -INFINITY;
+    }
+
+    // Folds ids loaded from a file into the bitset; ids not in the catalog
+    // stay in the list untouched
+    void sync(Player &p) const
+    {
+        AchievementState &st = p.achievement_state;
+        if (st.unlocked.size() != (count + 63) / 64 || st.synced > p.achievements.size())
+        {
+            st = AchievementState{};
+            st.unlocked.assign((count + 63) / 64, 0);
+            st.slot_value.assign(slots.size(), NAN);
+            st.slot_done.assign(slots.size(), 0);
+        }
+        for (; st.synced < p.achievements.size(); ++st.synced)
+        {
+            auto it = by_id.find(p.achievements[st.synced]);
+            if (it != by_id.end()) st.set(it->second);
+        }
+    }
+
+    // Unlocks every rule whose stat now meets its threshold; returns the
+    // catalog indices unlocked by this call. Slots whose value has not
+    // changed since the last call, or whose rules are all unlocked, are skipped.
+    vector<uint32_t> evaluate(Player &p) const
+    {
+        sync(p);
+        AchievementState &st = p.achievement_state;
+        vector<uint32_t> newly;
+        for (size_t k = 0; k < slots.size(); ++k)
+        {
+            const Slot &s = slots[k];
+            if (st.slot_done[k] == s.rules.size()) continue;
+            double v = value(s, p);
+            if (v == st.slot_value[k]) continue;
+            st.slot_value[k] = v;
+
+            size_t i = st.slot_done[k];
+            for (; i < s.rules.size() && defs[s.rules[i]].at_least <= v; ++i)
+            {
+                uint32_t r = s.rules[i];
+                if (st.has(r)) continue;
+                st.set(r);
+                p.achievements.push_back(defs[r].id);
+                newly.push_back(r);
+            }
+            st.slot_done[k] = (uint32_t)i;
+        }
+        st.synced = p.achievements.size();
+        return newly;
+    }
+};
+
+static const AchievementEngine &achievements()
+{
+    static const AchievementEngine engine(ACHIEVEMENT_CATALOG, sizeof(ACHIEVEMENT_CATALOG) / sizeof(AchievementDef));
+    return engine;
+}
+
+void evaluate_achievements(Player &p, bool notify_new)
+{
+    const AchievementEngine &eng = achievements();
+    vector<uint32_t> newly = eng.evaluate(p);
+
+    if (notify_new)
+    {
+        for (uint32_t r : newly)
+            draw_toast(string("Achievement unlocked: ") + eng.defs[r].name + " 🎉");
+    }
+}
+
+void show_achievements_screen(Player &p)
+{
+    const AchievementEngine &eng = achievements();
+    eng.sync(p);
+
+    auto draw = [&]
+    {
+        draw_bg_with_dimmer(0.45);
+        draw_hud("Achievements");
+
+        int x = 40, y = 80, h = 64, w = screen_width() - 80;
+
+        for (size_t i = 0; i < eng.count; ++i)
+        {
+            const AchievementDef &d = eng.defs[i];
+            bool unlocked = p.achievement_state.has(i);
+            draw_card_row(x, y, w, h);
+            string title = (unlocked ? "✓ " : "• ") + string(d.name);
+            draw_ui_text(title, unlocked ? COL_OK : COL_SUB, x + 16, y + 12, 22);
+            draw_ui_text(d.desc, COL_TEXT, x + 16, y + 36, 16);
+            y += h + 12;
+        }
+
+        draw_ui_text("Press any key to return", COL_SUB, x, y + 8, 16);
+    };
+    auto update = []
+    {
+        bool done = key_typed(RETURN_KEY) || key_typed(ESCAPE_KEY) || mouse_clicked(LEFT_BUTTON)
+                    || key_typed(SPACE_KEY) || key_typed(A_KEY) || key_typed(B_KEY);
+        return done ? Step::LEAVE : Step::STAY;
+    };
+    run_scene(draw, update);
+}
+
+// =======================================================
+// Byte scanning for the JSON reader (SSE2 / AVX2, picked at startup)
+// =======================================================
+// Both scanners return the index of the first byte at or after `i` that
+// stops the scan, or `n` if there is none. Vector loads never read past `n`.
+static inline bool is_json_ws(char c) { return c == ' ' || c == '\n' || c == '\t' || c == '\r'; }
+
+static size_t scan_ws_scalar(const char *p, size_t i, size_t n)
+{
+    while (i < n && is_json_ws(p[i])) i++;
+    return i;
+}
+
+// First '"' or '\\'
+static size_t scan_str_scalar(const char *p, size_t i, size_t n)
+{
+    while (i < n && p[i] != '\"' && p[i] != '\\') i++;
+    return i;
+}
+
+#ifdef FPSHD_SIMD_X86
+__attribute__((target("sse2")))
+static size_t scan_ws_sse2(const char *p, size_t i, size_t n)
+{
+    const __m128i sp = _mm_set1_epi8(' '), nl = _mm_set1_epi8('\n');
+    const __m128i tb = _mm_set1_epi8('\t'), cr = _mm_set1_epi8('\r');
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+        __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, sp), _mm_cmpeq_epi8(v, nl)),
+                                  _mm_or_si128(_mm_cmpeq_epi8(v, tb), _mm_cmpeq_epi8(v, cr)));
+        unsigned stop = ~(unsigned)_mm_movemask_epi8(ws) & 0xFFFFu;
+        if (stop) return i + __builtin_ctz(stop);
+    }
+    return scan_ws_scalar(p, i, n);
+}
+
+__attribute__((target("sse2")))
+static size_t scan_str_sse2(const char *p, size_t i, size_t n)
+{
+    const __m128i q = _mm_set1_epi8('\"'), bs = _mm_set1_epi8('\\');
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+        unsigned hit = (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, q), _mm_cmpeq_epi8(v, bs)));
+        if (hit) return i + __builtin_ctz(hit);
+    }
+    return scan_str_scalar(p, i, n);
+}
+
+__attribute__((target("avx2")))
+static size_t scan_ws_avx2(const char *p, size_t i, size_t n)
+{
+    const __m256i sp = _mm256_set1_epi8(' '), nl = _mm256_set1_epi8('\n');
+    const __m256i tb = _mm256_set1_epi8('\t'), cr = _mm256_set1_epi8('\r');
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+        __m256i ws = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, sp), _mm256_cmpeq_epi8(v, nl)),
+                                     _mm256_or_si256(_mm256_cmpeq_epi8(v, tb), _mm256_cmpeq_epi8(v, cr)));
+        unsigned stop = ~(unsigned)_mm256_movemask_epi8(ws);
+        if (stop) return i + __builtin_ctz(stop);
+    }
+    return scan_ws_sse2(p, i, n);
+}
+
+__attribute__((target("avx2")))
+static size_t scan_str_avx2(const char *p, size_t i, size_t n)
+{
+    const __m256i q = _mm256_set1_epi8('\"'), bs = _mm256_set1_epi8('\\');
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+        unsigned hit = (unsigned)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, q), _mm256_cmpeq_epi8(v, bs)));
+        if (hit) return i + __builtin_ctz(hit);
+    }
+    return scan_str_sse2(p, i, n);
+}
+#endif
+
+struct ByteScanner
+{
+    const char *name;
+    size_t (*ws)(const char *, size_t, size_t);
+    size_t (*str)(const char *, size_t, size_t);
+};
+
+static ByteScanner pick_byte_scanner()
+{
+#ifdef FPSHD_SIMD_X86
+    // Whitespace runs and string bodies in our files are mostly under 16
+    // bytes, so the wider AVX2 loads buy nothing and measure slower (bench
+    // scan); it stays available for comparison there
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) return { "sse2", scan_ws_sse2, scan_str_sse2 };
+#endif
+    return { "scalar", scan_ws_scalar, scan_str_scalar };
+}
+
+static ByteScanner g_scan = pick_byte_scanner();
+
+// =======================================================
+// JSON helpers (writer + focused parser for our schema)
+// =======================================================
+// Streaming writer: everything is formatted into one reusable buffer that is
+// handed to the FILE in large blocks. With no FILE the buffer just
+// accumulates and can be read back through data().
+struct JsonWriter
+{
+    explicit JsonWriter(FILE *f = nullptr, size_t block_bytes = 1 << 20) : out(f), block(block_bytes)
+    {
+        buf.reserve(out != nullptr ? block + 4096 : 256);
+    }
+
+    JsonWriter &raw(string_view s) { buf.append(s.data(), s.size()); return spill(); }
+
+    JsonWriter &num(long long v)
+    {
+        char tmp[24];
+        auto r = to_chars(tmp, tmp + sizeof(tmp), v);
+        buf.append(tmp, (size_t)(r.ptr - tmp));
+        return spill();
+    }
+
+    // Shortest text that reads back as the same double; null for inf/nan
+    JsonWriter &real(double v)
+    {
+        if (!isfinite(v)) return raw("null");
+        char tmp[32];
+        auto r = to_chars(tmp, tmp + sizeof(tmp), v);
+        buf.append(tmp, (size_t)(r.ptr - tmp));
+        return spill();
+    }
+
+    // Quoted and escaped in place: plain runs are appended in one go
+    JsonWriter &str(string_view s)
+    {
+        buf += '\"';
+        size_t run = 0;
+        for (size_t i = 0; i < s.size(); ++i)
+        {
+            unsigned char c = (unsigned char)s[i];
+            if (c >= 0x20 && c != '\"' && c != '\\') continue;
+            buf.append(s.data() + run, i - run);
+            run = i + 1;
+            switch (c)
+            {
+                case '\"': buf += "\\\""; break;
+                case '\\': buf += "\\\\"; break;
+                case '\b': buf += "\\b";  break;
+                case '\f': buf += "\\f";  break;
+                case '\n': buf += "\\n";  break;
+                case '\r': buf += "\\r";  break;
+                case '\t': buf += "\\t";  break;
+                default:
+                {
+                    static const char hex[] = "0123456789abcdef";
+                    char u[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 15] };
+                    buf.append(u, 6);
+                }
+            }
+        }
+        buf.append(s.data() + run, s.size() - run);
+        buf += '\"';
+        return spill();
+    }
+
+    // Writes whatever is buffered; false if any write so far has failed
+    bool finish()
+    {
+        flush();
+        return ok;
+    }
+
+    const string &data() const { return buf; }
+    void clear() { buf.clear(); }
+
+private:
+    JsonWriter &spill()
+    {
+        if (out != nullptr && buf.size() >= block) flush();
+        return *this;
+    }
+
+    void flush()
+    {
+        if (out == nullptr || buf.empty()) return;
+        if (fwrite(buf.data(), 1, buf.size(), out) != buf.size()) ok = false;
+        buf.clear();
+    }
+
+    FILE *out;
+    size_t block;
+    string buf;
+    bool ok = true;
+};
+
+// The reader works on a string_view over the raw file bytes (see MappedFile):
+// keys are compared as views and numbers go through from_chars, so the only
+// allocations are the string fields that end up stored in a Session.
+static void skip_ws(string_view s, size_t &i)
+{
+    // Most tokens are not preceded by whitespace; only runs go to the vector scanner
+    if (i < s.size() && !is_json_ws(s[i])) return;
+    i = g_scan.ws(s.data(), i, s.size());
+}
+
+static bool match_char(string_view s, size_t &i, char want)
+{
+    skip_ws(s, i);
+    if (i < s.size() && s[i] == want) { i++; return true; }
+    return false;
+}
+
+// Raw body of a quoted string (escapes left as-is). `escaped` tells the caller
+// whether it has to be decoded.
+static bool scan_string_raw(string_view s, size_t &i, string_view &body, bool &escaped)
+{
+    skip_ws(s, i);
+    if (i >= s.size() || s[i] != '\"') return false;
+    size_t start = ++i;
+    escaped = false;
+    while (true)
+    {
+        i = g_scan.str(s.data(), i, s.size());
+        if (i >= s.size()) return false;
+        if (s[i] == '\"') { body = s.substr(start, i - start); i++; return true; }
+        escaped = true;
+        i += 2; // backslash + escaped byte
+        if (i > s.size()) return false;
+    }
+}
+
+static bool unescape_into(string_view raw, string &out)
+{
+    out.clear();
+    out.reserve(raw.size());
+    for (size_t i = 0; i < raw.size(); )
+    {
+        // Copy the plain run up to the next escape in one go
+        size_t j = g_scan.str(raw.data(), i, raw.size());
+        out.append(raw.data() + i, j - i);
+        if (j >= raw.size()) break;
+        i = j + 1;
+        if (i >= raw.size()) return false;
+        char e = raw[i++];
+        switch (e)
+        {
+            case '\"': out += '\"'; break;
+            case '\\': out += '\\'; break;
+            case '/':  out += '/';  break;
+            case 'b':  out += '\b'; break;
+            case 'f':  out += '\f'; break;
+            case 'n':  out += '\n'; break;
+            case 'r':  out += '\r'; break;
+            case 't':  out += '\t'; break;
+            case 'u':
+            {
+                if (i + 4 > raw.size()) return false;
+                for (int k = 0; k < 4; ++k)
+                {
+                    char h = raw[i++];
+                    if (!isxdigit((unsigned char)h)) return false;
+                }
+                out += '?'; // skip unicode -> placeholder
+                break;
+            }
+            default: return false;
+        }
+    }
+    return true;
+}
+
+static bool parse_string_quoted(string_view s, size_t &i, string &out)
+{
+    string_view raw; bool escaped;
+    if (!scan_string_raw(s, i, raw, escaped)) return false;
+    if (!escaped) { out.assign(raw.data(), raw.size()); return true; }
+    return unescape_into(raw, out);
+}
+
+// Object keys in our schema never need decoding; an escaped key simply
+// won't match any known name and its value is skipped.
+static bool parse_key(string_view s, size_t &i, string_view &key)
+{
+    bool escaped;
+    if (!scan_string_raw(s, i, key, escaped)) return false;
+    return match_char(s, i, ':');
+}
+
+static bool parse_integer(string_view s, size_t &i, long long &out)
+{
+    skip_ws(s, i);
+    if (i >= s.size()) return false;
+    const char *first = s.data() + i;
+    auto r = from_chars(first, s.data() + s.size(), out);
+    if (r.ec != errc()) return false;
+    i += (size_t)(r.ptr - first);
+    return true;
+}
+
+static bool parse_literal(string_view s, size_t &i, const char *lit)
+{
+    skip_ws(s, i);
+    size_t n = strlen(lit);
+    if (s.compare(i, n, lit) != 0) return false;
+    i += n;
+    return true;
+}
+
+static bool skip_value(string_view s, size_t &i); // fwd
+static bool skip_array(string_view s, size_t &i)
+{
+    if (!match_char(s, i, '[')) return false;
+    skip_ws(s, i);
+    if (match_char(s, i, ']')) return true;
+    while (true)
+    {
+        if (!skip_value(s, i)) return false;
+        skip_ws(s, i);
+        if (match_char(s, i, ']')) return true;
+        if (!match_char(s, i, ',')) return false;
+    }
+}
+static bool skip_object(string_view s, size_t &i)
+{
+    if (!match_char(s, i, '{')) return false;
+    skip_ws(s, i);
+    if (match_char(s, i, '}')) return true;
+    while (true)
+    {
+        string_view k;
+        if (!parse_key(s, i, k)) return false;
+        if (!skip_value(s, i)) return false;
+        skip_ws(s, i);
+        if (match_char(s, i, '}')) return true;
+        if (!match_char(s, i, ',')) return false;
+    }
+}
+static bool skip_value(string_view s, size_t &i)
+{
+    skip_ws(s, i);
+    if (i >= s.size()) return false;
+    char c = s[i];
+    if (c == '\"') { string_view raw; bool esc; return scan_string_raw(s, i, raw, esc); }
+    if (c == '{') return skip_object(s, i);
+    if (c == '[') return skip_array(s, i);
+    if (c == 't') return parse_literal(s, i, "true");
+    if (c == 'f') return parse_literal(s, i, "false");
+    if (c == 'n') return parse_literal(s, i, "null");
+    if (c == '-' || isdigit((unsigned char)c)) { long long num; return parse_integer(s, i, num); }
+    return false;
+}
+
+// One session object, filled straight into its row in the store
+static bool parse_session_object(string_view s, size_t &i, Session &out)
+{
+    if (!match_char(s, i, '{')) return false;
+    bool has_game_type = false;
+    out.kills = out.deaths = out.assists = 0;
+    if (match_char(s, i, '}')) { out.game_type = GameType::Unknown; return true; }
+
+    while (true)
+    {
+        string_view key;
+        if (!parse_key(s, i, key)) return false;
+
+        if (key == "game_name")
+        {
+            if (!parse_string_quoted(s, i, out.game_name)) return false;
+        }
+        else if (key == "game_type")
+        {
+            long long v; if (!parse_integer(s, i, v)) return false;
+            int vi = (int)v;
+            if (vi < 0 || vi > 2) out.game_type = GameType::Unknown; // clamp bad ints
+            else                  out.game_type = static_cast<GameType>(vi);
+            has_game_type = true;
+        }
+        else if (key == "kills")
+        {
+            long long v; if (!parse_integer(s, i, v)) return false; out.kills = (int)v;
+        }
+        else if (key == "deaths")
+        {
+            long long v; if (!parse_integer(s, i, v)) return false; out.deaths = (int)v;
+        }
+        else if (key == "assists")
+        {
+            long long v; if (!parse_integer(s, i, v)) return false; out.assists = (int)v;
+        }
+        else if (key == "rank")
+        {
+            if (!parse_string_quoted(s, i, out.rank)) return false;
+        }
+        else if (key == "outcome")
+        {
+            if (!parse_string_quoted(s, i, out.outcome)) return false;
+        }
+        else if (key == "session_date")
+        {
+            if (!parse_string_quoted(s, i, out.session_date)) return false;
+        }
+        else
+        {
+            if (!skip_value(s, i)) return false;
+        }
+
+        if (match_char(s, i, '}'))
+        {
+            // SessionStore normalizes legacy/bad ints vs names afterwards
+            if (!has_game_type) out.game_type = parse_game_type(out.game_name);
+            return true;
+        }
+        if (!match_char(s, i, ',')) return false;
+    }
+}
+
+// Parse array of sessions
+static bool parse_sessions_array(string_view s, size_t &i, SessionStore &store)
+{
+    if (!match_char(s, i, '[')) return false;
+    if (match_char(s, i, ']')) return true;
+
+    while (true)
+    {
+        if (!store.append_with([&](Session &row){ return parse_session_object(s, i, row); })) return false;
+        if (match_char(s, i, ']')) return true;
+        if (!match_char(s, i, ',')) return false;
+    }
+}
+
+// Parse ["id","id2",...]
+static bool parse_string_array(string_view s, size_t &i, vector<string> &out)
+{
+    if (!match_char(s, i, '[')) return false;
+    if (match_char(s, i, ']')) return true;
+    while (true)
+    {
+        string v;
+        if (!parse_string_quoted(s, i, v)) return false;
+        out.push_back(std::move(v));
+        if (match_char(s, i, ']')) return true;
+        if (!match_char(s, i, ',')) return false;
+    }
+}
+
+// Parses straight into `p`; on failure `p` is left partially filled and the
+// caller is expected to reset it.
+static bool parse_player_json(string_view s, Player &p)
+{
+    size_t i = 0;
+    if (!match_char(s, i, '{')) return false;
+    if (match_char(s, i, '}')) return true;
+
+    while (true)
+    {
+        string_view key;
+        if (!parse_key(s, i, key)) return false;
+
+        if (key == "player_name")
+        {
+            if (!parse_string_quoted(s, i, p.player_name)) return false;
+        }
+        else if (key == "preferred_game")
+        {
+            if (!parse_string_quoted(s, i, p.preferred_game)) return false;
+        }
+        else if (key == "sessions")
+        {
+            p.sessions.clear();
+            // A session object is at least ~100 bytes even minified; no extra pass over the file
+            p.sessions.reserve(min((s.size() - i) / 100, (size_t)1 << 22));
+            if (!parse_sessions_array(s, i, p.sessions)) return false;
+        }
+        else if (key == "achievements")
+        {
+            p.achievements.clear();
+            if (!parse_string_array(s, i, p.achievements)) return false;
+        }
+        else if (key == "generation")
+        {
+            long long v; if (!parse_integer(s, i, v)) return false;
+            p.generation = (v < 0) ? 0 : (uint64_t)v;
+        }
+        else
+        {
+            if (!skip_value(s, i)) return false;
+        }
+
+        if (match_char(s, i, '}')) return true;
+        if (!match_char(s, i, ',')) return false;
+    }
+}
+
+// =======================================================
+// Persistence (JSON + legacy TXT support) with Atomic Save
+// =======================================================
+static string safe_name(const string &raw)
+{
+    if (raw.empty()) return "default";
+    string s = raw;
+    for (char &c : s) if (strchr("/\\:*?\"<>|", c)) c = '_';
+    return s;
+}
+
+static inline string json_filename(const string &name) { return safe_name(name) + "_data.json"; }
+static inline string txt_filename (const string &name) { return safe_name(name) + "_data.txt";  }
+static inline string bak_filename (const string &name, bool bin) { return safe_name(name) + (bin ? "_data.bin.bak" : "_data.json.bak"); }
+static inline string tmp_filename (const string &name) { return safe_name(name) + "_data.tmp";  }
+static inline string jnl_filename (const string &name) { return safe_name(name) + "_data.journal"; }
+static inline string bin_filename (const string &name) { return safe_name(name) + "_data.bin";  }
+
+// Read-only view of a whole file: mmap on POSIX, a single read elsewhere
+struct MappedFile
+{
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile() { close(); }
+
+    bool open(const string &path)
+    {
+        close();
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) { ::close(fd); return false; }
+        len = (size_t)st.st_size;
+        if (len > 0)
+        {
+#ifdef MAP_POPULATE
+            // Readers walk the whole file; one populate beats a fault per page
+            void *m = mmap(nullptr, len, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+#else
+            void *m = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+#endif
+            if (m == MAP_FAILED) { ::close(fd); len = 0; return false; }
+            madvise(m, len, MADV_SEQUENTIAL);
+            base = static_cast<const char *>(m);
+        }
+        ::close(fd);
+        return true;
+#else
+        ifstream in(path, ios::binary);
+        if (!in) return false;
+        in.seekg(0, ios::end);
+        buffer.resize((size_t)in.tellg());
+        in.seekg(0, ios::beg);
+        in.read(&buffer[0], (streamsize)buffer.size());
+        base = buffer.data();
+        len = buffer.size();
+        return true;
+#endif
+    }
+
+    void close()
+    {
+#ifndef _WIN32
+        if (base != nullptr) munmap(const_cast<char *>(base), len);
+#else
+        buffer.clear();
+#endif
+        base = nullptr;
+        len = 0;
+    }
+
+    string_view view() const { return string_view(base != nullptr ? base : "", len); }
+
+private:
+    const char *base = nullptr;
+    size_t len = 0;
+#ifdef _WIN32
+    string buffer;
+#endif
+};
+
+bool profile_exists(const string &name)
+{
+    return fs::exists(bin_filename(name)) || fs::exists(json_filename(name)) || fs::exists(txt_filename(name));
+}
+
+static bool load_player_legacy(Player &p, const string &name)
+{
+    string f = txt_filename(name);
+    ifstream in(f);
+    if (!in) return false;
+
+    p = Player();
+
+    getline(in, p.player_name);
+    getline(in, p.preferred_game);
+
+    int n;
+    if (!(in >> n)) { draw_toast("Legacy load failed: invalid file."); return false; }
+    in.ignore();
+    if (n > 0) p.sessions.reserve(min(n, 1 << 20));
+
+    for (int i = 0; i < n; ++i)
+    {
+        Session s{}; int gtype = 0;
+        if (!getline(in, s.game_name)) break;
+        if (!(in >> gtype)) break; in.ignore();
+        s.game_type = static_cast<GameType>(gtype);
+        if (!(in >> s.kills >> s.deaths >> s.assists)) break; in.ignore();
+        if (!getline(in, s.rank)) break;
+        if (!getline(in, s.outcome)) break;
+        if (!getline(in, s.session_date)) break;
+
+        p.sessions.push_back(std::move(s));
+    }
+    return true;
+}
+
+// Pretty JSON: the snapshot format for small profiles and the export format
+static bool write_player_json(const Player &p, FILE *f)
+{
+    JsonWriter out(f);
+    out.raw("{\n");
+    out.raw("  \"player_name\": ").str(p.player_name).raw(",\n");
+    out.raw("  \"preferred_game\": ").str(p.preferred_game).raw(",\n");
+    out.raw("  \"generation\": ").num((long long)p.generation).raw(",\n");
+    out.raw("  \"sessions\": [\n");
+
+    for (size_t i = 0; i < p.sessions.size(); ++i)
+    {
+        const Session &s = p.sessions[i];
+        out.raw("    {\n");
+        out.raw("      \"game_name\": ").str(s.game_name).raw(",\n");
+        out.raw("      \"game_type\": ").num(static_cast<int>(s.game_type)).raw(",\n");
+        out.raw("      \"kills\": ").num(s.kills).raw(",\n");
+        out.raw("      \"deaths\": ").num(s.deaths).raw(",\n");
+        out.raw("      \"assists\": ").num(s.assists).raw(",\n");
+        out.raw("      \"rank\": ").str(s.rank).raw(",\n");
+        out.raw("      \"outcome\": ").str(s.outcome).raw(",\n");
+        out.raw("      \"session_date\": ").str(s.session_date).raw("\n");
+        out.raw(i + 1 < p.sessions.size() ? "    },\n" : "    }\n");
+    }
+
+    out.raw("  ],\n");
+    out.raw("  \"achievements\": [");
+    for (size_t i = 0; i < p.achievements.size(); ++i)
+    {
+        out.str(p.achievements[i]);
+        if (i + 1 < p.achievements.size()) out.raw(", ");
+    }
+    out.raw("]\n");
+    out.raw("}\n");
+    return out.finish();
+}
+
+// -------------------------------------------------------
+// Binary snapshot: <name>_data.bin
+// -------------------------------------------------------
+// [BinHeader]
+// [string table: u32 offsets x (string_count + 1), then the bytes]
+// [achievement string ids: u32 x achievement_count]
+// [columns, one per BinColumn, each n values wide and 8-byte aligned]
+// Values are host-endian; byte_order lets a foreign file be rejected
+// instead of misread. Dates are stored as parse_date_key keys; the text is
+// only kept (date_text) when it did not parse.
+static const char     BIN_MAGIC[8]    = { 'F','P','S','H','D','B','I','N' };
+static const uint32_t BIN_VERSION     = 1;
+static const uint32_t BIN_BYTE_ORDER  = 0x01020304u;
+static const uint32_t BIN_NO_STRING   = 0xFFFFFFFFu;
+static const size_t   BIN_SNAPSHOT_MIN_SESSIONS = 5000; // smaller profiles stay JSON
+
+enum BinColumn
+{
+    COL_KILLS, COL_DEATHS, COL_ASSISTS, COL_DATE_KEY,          // i32
+    COL_RANK_ID, COL_OUTCOME_ID, COL_GAME_NAME_ID, COL_DATE_TEXT_ID, // u32 string ids
+    COL_GAME_TYPE,                                             // u8
+    BIN_COLUMN_COUNT
+};
+
+struct BinHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t generation;
+    uint64_t session_count;
+    uint32_t string_count;
+    uint32_t achievement_count;
+    uint32_t player_name_id;
+    uint32_t preferred_game_id;
+    uint64_t strings_offset;
+    uint64_t achievements_offset;
+    uint64_t column_offset[BIN_COLUMN_COUNT];
+    uint64_t file_size;
+};
+
+static size_t bin_column_width(int c) { return c == COL_GAME_TYPE ? 1 : 4; }
+static uint64_t align8(uint64_t v) { return (v + 7) & ~(uint64_t)7; }
+
+// n items of `width` bytes at `off` lie inside a file of `size` bytes;
+// written so that no header value can wrap the arithmetic
+static bool bin_span_ok(uint64_t off, uint64_t n, uint64_t width, uint64_t size)
+{
+    return off <= size && n <= (size - off) / width;
+}
+
+static string date_from_key(int key)
+{
+    char b[10];
+    int y = key / 10000, m = (key / 100) % 100, d = key % 100;
+    b[0] = char('0' + y / 1000); b[1] = char('0' + (y / 100) % 10); b[2] = char('0' + (y / 10) % 10); b[3] = char('0' + y % 10);
+    b[4] = '-'; b[5] = char('0' + m / 10); b[6] = char('0' + m % 10);
+    b[7] = '-'; b[8] = char('0' + d / 10); b[9] = char('0' + d % 10);
+    return string(b, 10);
+}
+
+static bool write_player_bin(const Player &p, FILE *f)
+{
+    const size_t n = p.sessions.size();
+
+    // Intern every string once; the views point into `p`, which outlives this call
+    vector<string_view> strings;
+    unordered_map<string_view, uint32_t> ids;
+    auto intern = [&](string_view s) -> uint32_t
+    {
+        auto it = ids.find(s);
+        if (it != ids.end()) return it->second;
+        uint32_t id = (uint32_t)strings.size();
+        strings.push_back(s);
+        ids.emplace(s, id);
+        return id;
+    };
+
+    BinHeader h{};
+    memcpy(h.magic, BIN_MAGIC, sizeof(h.magic));
+    h.version = BIN_VERSION;
+    h.byte_order = BIN_BYTE_ORDER;
+    h.generation = p.generation;
+    h.session_count = n;
+    h.player_name_id = intern(p.player_name);
+    h.preferred_game_id = intern(p.preferred_game);
+
+    vector<uint32_t> ach;
+    for (const auto &a : p.achievements) ach.push_back(intern(a));
+
+    vector<int32_t> kills(n), deaths(n), assists(n), date_key(n);
+    vector<uint32_t> rank(n), outcome(n), game(n), date_text(n);
+    vector<uint8_t> gtype(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        const Session &s = p.sessions[i];
+        kills[i] = s.kills; deaths[i] = s.deaths; assists[i] = s.assists;
+        int key = 0;
+        bool canonical = parse_date_key(s.session_date, key);
+        date_key[i]  = canonical ? key : p.sessions.date_key(i);
+        date_text[i] = canonical ? BIN_NO_STRING : intern(s.session_date);
+        rank[i]    = intern(s.rank);
+        outcome[i] = intern(s.outcome);
+        game[i]    = intern(s.game_name);
+        gtype[i]   = (uint8_t)s.game_type;
+    }
+
+    vector<uint32_t> str_offsets;
+    str_offsets.reserve(strings.size() + 1);
+    uint32_t total = 0;
+    for (auto sv : strings) { str_offsets.push_back(total); total += (uint32_t)sv.size(); }
+    str_offsets.push_back(total);
+
+    h.string_count = (uint32_t)strings.size();
+    h.achievement_count = (uint32_t)ach.size();
+    h.strings_offset = align8(sizeof(BinHeader));
+    h.achievements_offset = align8(h.strings_offset + str_offsets.size() * 4 + total);
+    uint64_t at = align8(h.achievements_offset + ach.size() * 4);
+    for (int c = 0; c < BIN_COLUMN_COUNT; ++c)
+    {
+        h.column_offset[c] = at;
+        at = align8(at + n * bin_column_width(c));
+    }
+    h.file_size = at;
+
+    // Sequential write; padding is emitted so every section lands on its offset
+    uint64_t written = 0;
+    bool ok = true;
+    auto put = [&](const void *data, size_t bytes)
+    {
+        if (ok && bytes > 0 && fwrite(data, 1, bytes, f) != bytes) ok = false;
+        written += bytes;
+    };
+    auto pad_to = [&](uint64_t off)
+    {
+        static const char zeros[8] = {};
+        if (off > written) put(zeros, (size_t)(off - written));
+    };
+
+    put(&h, sizeof(h));
+    pad_to(h.strings_offset);
+    put(str_offsets.data(), str_offsets.size() * 4);
+    for (auto sv : strings) put(sv.data(), sv.size());
+    pad_to(h.achievements_offset);
+    put(ach.data(), ach.size() * 4);
+
+    const void *cols[BIN_COLUMN_COUNT] = {
+        kills.data(), deaths.data(), assists.data(), date_key.data(),
+        rank.data(), outcome.data(), game.data(), date_text.data(), gtype.data()
+    };
+    for (int c = 0; c < BIN_COLUMN_COUNT; ++c)
+    {
+        pad_to(h.column_offset[c]);
+        put(cols[c], n * bin_column_width(c));
+    }
+    pad_to(h.file_size);
+    return ok;
+}
+
+// Maps the snapshot and builds rows straight from the columns; nothing is
+// parsed per record and each distinct string is interned once. False if the
+// file is missing or fails validation.
+static bool load_player_bin(Player &p, const string &name)
+{
+    MappedFile in;
+    if (!in.open(bin_filename(name))) return false;
+    string_view s = in.view();
+
+    BinHeader h;
+    bool ok = s.size() >= sizeof(h);
+    if (ok) memcpy(&h, s.data(), sizeof(h));
+    ok = ok && memcmp(h.magic, BIN_MAGIC, sizeof(h.magic)) == 0
+            && h.version == BIN_VERSION && h.byte_order == BIN_BYTE_ORDER
+            && h.file_size == s.size()
+            && h.strings_offset % 4 == 0 && bin_span_ok(h.strings_offset, (uint64_t)h.string_count + 1, 4, s.size())
+            && h.achievements_offset % 4 == 0 && bin_span_ok(h.achievements_offset, h.achievement_count, 4, s.size());
+    for (int c = 0; ok && c < BIN_COLUMN_COUNT; ++c)
+        ok = h.column_offset[c] % 8 == 0 && bin_span_ok(h.column_offset[c], h.session_count, bin_column_width(c), s.size());
+    if (!ok) { draw_toast("Load failed: bad binary snapshot. Trying JSON..."); return false; }
+
+    const uint32_t *str_off = reinterpret_cast<const uint32_t *>(s.data() + h.strings_offset);
+    const char *str_bytes = s.data() + h.strings_offset + ((size_t)h.string_count + 1) * 4;
+    const uint64_t str_limit = s.size() - (uint64_t)(str_bytes - s.data());
+    auto str = [&](uint32_t id, string_view &out) -> bool
+    {
+        if (id >= h.string_count || str_off[id] > str_off[id + 1] || str_off[id + 1] > str_limit) return false;
+        out = string_view(str_bytes + str_off[id], str_off[id + 1] - str_off[id]);
+        return true;
+    };
+    auto col32 = [&](int c) { return reinterpret_cast<const int32_t *>(s.data() + h.column_offset[c]); };
+    auto colid = [&](int c) { return reinterpret_cast<const uint32_t *>(s.data() + h.column_offset[c]); };
+
+    p = Player();
+    string_view sv;
+    if (!str(h.player_name_id, sv)) ok = false; else p.player_name.assign(sv);
+    if (!str(h.preferred_game_id, sv)) ok = false; else p.preferred_game.assign(sv);
+    p.generation = h.generation;
+
+    const uint32_t *ach = reinterpret_cast<const uint32_t *>(s.data() + h.achievements_offset);
+    for (uint32_t a = 0; ok && a < h.achievement_count; ++a)
+    {
+        if (!str(ach[a], sv)) ok = false;
+        else p.achievements.emplace_back(sv);
+    }
+
+    vector<string_view> texts(ok ? h.string_count : 0);
+    for (uint32_t t = 0; ok && t < h.string_count; ++t) ok = str(t, texts[t]);
+    SnapshotStrings strings(std::move(texts));
+
+    const int32_t *kills = col32(COL_KILLS), *deaths = col32(COL_DEATHS), *assists = col32(COL_ASSISTS);
+    const int32_t *date_key = col32(COL_DATE_KEY);
+    const uint32_t *rank = colid(COL_RANK_ID), *outcome = colid(COL_OUTCOME_ID);
+    const uint32_t *game = colid(COL_GAME_NAME_ID), *date_text = colid(COL_DATE_TEXT_ID);
+    const uint8_t *gtype = reinterpret_cast<const uint8_t *>(s.data() + h.column_offset[COL_GAME_TYPE]);
+
+    p.sessions.reserve((size_t)h.session_count);
+    for (uint64_t i = 0; ok && i < h.session_count; ++i)
+    {
+        GameType g = gtype[i] <= (uint8_t)GameType::Unknown ? static_cast<GameType>(gtype[i]) : GameType::Unknown;
+        string date;
+        if (date_text[i] == BIN_NO_STRING) date = date_from_key(date_key[i]);
+        else if (date_text[i] < h.string_count) date.assign(strings.texts[date_text[i]]);
+        else { ok = false; break; }
+        ok = p.sessions.push_back_ids(strings, kills[i], deaths[i], assists[i], date_key[i], g,
+                                      game[i], rank[i], outcome[i], std::move(date));
+    }
+
+    if (!ok)
+    {
+        p = Player();
+        draw_toast("Load failed: bad binary snapshot. Trying JSON...");
+        return false;
+    }
+    return true;
+}
+
+// Atomic snapshot write with backup. Callers go through save_player, which
+// also retires the journal the snapshot now covers. Large profiles (or ones
+// already stored as binary) get the binary format, the rest stay JSON.
+static bool write_snapshot(const Player &p)
+{
+    if (p.player_name.empty()) return false;
+
+    bool as_bin = p.sessions.size() >= BIN_SNAPSHOT_MIN_SESSIONS || fs::exists(bin_filename(p.player_name));
+    string jf  = as_bin ? bin_filename(p.player_name) : json_filename(p.player_name);
+    string other = as_bin ? json_filename(p.player_name) : bin_filename(p.player_name);
+    string tf  = tmp_filename(p.player_name);
+
+    // 1) Write to temp file
+    {
+        FILE *f = fopen(tf.c_str(), as_bin ? "wb" : "w");
+        if (f == nullptr)
+        {
+            draw_toast("Save failed: cannot open temp file.");
+            return false;
+        }
+        setvbuf(f, nullptr, _IONBF, 0); // writers already write in large blocks
+
+        bool written = as_bin ? write_player_bin(p, f) : write_player_json(p, f);
+        if (fclose(f) != 0) written = false;
+        if (!written)
+        {
+            draw_toast("Save failed: could not write temp file.");
+            return false;
+        }
+    }
+
+    // 2) Backup current snapshot to .bak (best effort), named after its own
+    // format so a restore never feeds binary to the JSON reader or back
+    std::error_code ec;
+    bool current_bin = fs::exists(jf) ? as_bin : !as_bin;
+    string current = current_bin ? bin_filename(p.player_name) : json_filename(p.player_name);
+    if (fs::exists(current))
+    {
+        fs::copy_file(current, bak_filename(p.player_name, current_bin), fs::copy_options::overwrite_existing, ec);
+        // If copy fails we still proceed, but user keeps the temp file as fallback if next step fails.
+    }
+
+    // 3) Atomically replace: rename temp -> main
+    fs::rename(tf, jf, ec);
+    if (ec)
+    {
+        // Try overwrite by copy if rename failed (e.g., cross-device)
+        ec.clear();
+        fs::copy_file(tf, jf, fs::copy_options::overwrite_existing, ec);
+        if (!ec)
+        {
+            fs::remove(tf); // cleanup temp
+        }
+        else
+        {
+            draw_toast("Save failed: could not replace data file.");
+            return false;
+        }
+    }
+
+    // 4) Only one snapshot format is live at a time
+    fs::remove(other, ec);
+    // draw_toast("Saved.");
+    return true;
+}
+
+// JSON stays the interchange format whatever the snapshot format is
+bool export_profile_json(const Player &p, const string &path)
+{
+    FILE *f = fopen(path.c_str(), "w");
+    if (f == nullptr) return false;
+    setvbuf(f, nullptr, _IONBF, 0);
+    bool ok = write_player_json(p, f);
+    if (fclose(f) != 0) ok = false;
+    return ok;
+}
+
+bool import_profile_json(Player &p, const string &path)
+{
+    MappedFile in;
+    if (!in.open(path)) return false;
+    p = Player();
+    if (!parse_player_json(in.view(), p)) { p = Player(); return false; }
+    evaluate_achievements(p, false);
+    return true;
+}
+
+// -------------------------------------------------------
+// Session journal: <name>_data.journal, one record per line
+//   G <gen>         following records apply on top of snapshot generation <gen>
+//   A {session}     session appended (compact JSON object)
+//   D <index>       session at 0-based <index> deleted
+//   U "<id>"        achievement unlocked
+// Adds and deletes append one fsync'd record instead of rewriting the
+// snapshot; save_player folds everything back into a new snapshot.
+// -------------------------------------------------------
+static bool journal_needs_compaction(const Player &p)
+{
+    return p.journal_records >= max(256, (int)(p.sessions.size() / 4));
+}
+
+static void write_session_compact(JsonWriter &w, const Session &s)
+{
+    w.raw("{\"game_name\":").str(s.game_name);
+    w.raw(",\"game_type\":").num(static_cast<int>(s.game_type));
+    w.raw(",\"kills\":").num(s.kills);
+    w.raw(",\"deaths\":").num(s.deaths);
+    w.raw(",\"assists\":").num(s.assists);
+    w.raw(",\"rank\":").str(s.rank);
+    w.raw(",\"outcome\":").str(s.outcome);
+    w.raw(",\"session_date\":").str(s.session_date);
+    w.raw("}");
+}
+
+// Held while the journal is appended to or retired; the save worker may be
+// finishing a snapshot of the same profile at the same time
+static mutex g_journal_lock;
+static uint64_t g_journal_appends = 0;  // bumped by every append, under g_journal_lock
+
+static bool journal_append(Player &p, const string &records, int count)
+{
+    if (p.player_name.empty()) return false;
+    string jf = jnl_filename(p.player_name);
+    lock_guard<mutex> lk(g_journal_lock);
+    bool fresh = !fs::exists(jf);
+
+    FILE *f = fopen(jf.c_str(), "ab");
+    if (f == nullptr) return false;
+
+    bool ok = true;
+    // Every process's first append opens a section for its own generation,
+    // so records never land under a stale journal's older header. The
+    // leading newline ends any record a crash left torn.
+    if (fresh || p.journal_gen != p.generation)
+    {
+        string head = (fresh ? "G " : "\nG ") + to_string(p.generation) + "\n";
+        ok = fwrite(head.data(), 1, head.size(), f) == head.size();
+    }
+    ok = ok && fwrite(records.data(), 1, records.size(), f) == records.size();
+    ok = ok && fflush(f) == 0;
+#ifndef _WIN32
+    ok = ok && fsync(fileno(f)) == 0;
+#else
+    ok = ok && _commit(_fileno(f)) == 0;
+#endif
+    if (fclose(f) != 0) ok = false;
+
+    g_journal_appends++;
+    if (ok) { p.journal_records += count; p.journal_gen = p.generation; }
+    return ok;
+}
+
+// Achievements unlocked since `before` (index into p.achievements)
+static void journal_unlocks(JsonWriter &w, const Player &p, size_t before, int &count)
+{
+    for (size_t i = before; i < p.achievements.size(); ++i)
+    {
+        w.raw("U ").str(p.achievements[i]).raw("\n");
+        count++;
+    }
+}
+
+bool journal_add_session(Player &p, size_t unlocks_before)
+{
+    JsonWriter w;
+    w.raw("A ");
+    write_session_compact(w, p.sessions[p.sessions.size() - 1]);
+    w.raw("\n");
+    int count = 1;
+    journal_unlocks(w, p, unlocks_before, count);
+    return journal_append(p, w.data(), count);
+}
+
+bool journal_delete_session(Player &p, size_t index, size_t unlocks_before)
+{
+    JsonWriter w;
+    w.raw("D ").num((long long)index).raw("\n");
+    int count = 1;
+    journal_unlocks(w, p, unlocks_before, count);
+    return journal_append(p, w.data(), count);
+}
+
+// Applies journal sections written against this snapshot generation (or a
+// later one). A torn or unreadable record ends its section quietly; replay
+// picks up again at the next G header. The generation is then raised to the
+// newest section seen, so the next snapshot supersedes every section
+// replayed here.
+static void replay_journal(Player &p, const string &name)
+{
+    MappedFile in;
+    if (!in.open(jnl_filename(name))) return;
+    string_view s = in.view();
+
+    bool active = false;
+    uint64_t newest = p.generation;
+    size_t pos = 0;
+    while (pos < s.size())
+    {
+        size_t eol = s.find('\n', pos);
+        if (eol == string_view::npos) break; // torn tail: record never completed
+        string_view line = s.substr(pos, eol - pos);
+        pos = eol + 1;
+        if (line.empty()) continue;
+        if (line.size() < 2 || line[1] != ' ') { active = false; continue; }
+
+        size_t i = 2;
+        char kind = line[0];
+        if (kind == 'G')
+        {
+            long long g; if (!parse_integer(line, i, g)) { active = false; continue; }
+            active = (g >= 0 && (uint64_t)g >= p.generation);
+            if (active) newest = max(newest, (uint64_t)g);
+            continue;
+        }
+        if (!active) continue;
+
+        bool ok = false;
+        if (kind == 'A')
+        {
+            ok = p.sessions.append_with([&](Session &row){ return parse_session_object(line, i, row); });
+        }
+        else if (kind == 'D')
+        {
+            long long idx;
+            ok = parse_integer(line, i, idx) && idx >= 0 && idx < (long long)p.sessions.size();
+            if (ok) p.sessions.erase((size_t)idx);
+        }
+        else if (kind == 'U')
+        {
+            string id;
+            ok = parse_string_quoted(line, i, id);
+            if (ok && find(p.achievements.begin(), p.achievements.end(), id) == p.achievements.end())
+                p.achievements.push_back(std::move(id));
+        }
+        if (!ok) { active = false; continue; }   // later records of this section built on this one
+        p.journal_records++;
+    }
+    p.generation = newest;
+}
+
+// Full save: writes a new snapshot generation and drops the journal it covers
+bool save_player(Player &p)
+{
+    if (p.player_name.empty()) return false;
+    p.generation++;
+    if (!write_snapshot(p))
+    {
+        p.generation--;
+        return false;
+    }
+    std::error_code ec;
+    lock_guard<mutex> lk(g_journal_lock);
+    fs::remove(jnl_filename(p.player_name), ec);
+    p.journal_records = 0;
+    return true;
+}
+
+// -------------------------------------------------------
+// Background saving: the UI thread hands over a copy of the profile and
+// carries on; one worker thread writes the snapshots. A save queued for a
+// profile that already has one waiting replaces it, so a burst of edits
+// costs one write. Failures come back through post_toast.
+// -------------------------------------------------------
+struct SaveWorker
+{
+    ~SaveWorker() { stop(); }
+
+    // `journal_mark` is g_journal_appends when the copy was taken
+    void submit(unique_ptr<Player> snap, uint64_t journal_mark)
+    {
+        lock_guard<mutex> lk(m);
+        if (!th.joinable()) th = thread([this] { run(); });
+        for (Job &j : queue)
+        {
+            if (j.snap->player_name != snap->player_name) continue;
+            j.snap = std::move(snap);
+            j.journal_mark = journal_mark;
+            return;
+        }
+        queue.push_back({ std::move(snap), journal_mark });
+        cv.notify_one();
+    }
+
+    // Blocks until everything submitted so far is on disk (or has failed)
+    void flush()
+    {
+        unique_lock<mutex> lk(m);
+        idle.wait(lk, [this] { return queue.empty() && !busy; });
+    }
+
+    void stop()
+    {
+        {
+            lock_guard<mutex> lk(m);
+            quit = true;
+        }
+        cv.notify_one();
+        if (th.joinable()) th.join();
+        quit = false;
+    }
+
+private:
+    struct Job
+    {
+        unique_ptr<Player> snap;
+        uint64_t journal_mark;
+    };
+
+    void run()
+    {
+        vector<string> notes;
+        t_toast_sink = &notes;      // write_snapshot's toasts become posted toasts
+        unique_lock<mutex> lk(m);
         while (true)
         {
-            string key;
-            if (!parse_string_quoted(s, i, key)) return false;
-            if (!match_char(s, i, ':')) return false;
+            cv.wait(lk, [this] { return quit || !queue.empty(); });
+            if (queue.empty()) break;   // quit, and everything is written
+            Job job = std::move(queue.front());
+            queue.pop_front();
+            busy = true;
+            lk.unlock();
+
+            if (write_snapshot(*job.snap)) retire_journal(job.snap->player_name, job.journal_mark);
+            for (const string &n : notes) post_toast(n);
+            notes.clear();
+            job.snap.reset();
+
+            lk.lock();
+            busy = false;
+            if (queue.empty()) idle.notify_all();
+        }
+        t_toast_sink = nullptr;
+    }
 
-            if (key == "game_name")
-            {
-                if (!parse_string_quoted(s, i, temp.game_name)) return false;
-            }
-            else if (key == "game_type")
-            {
-                long long v; if (!parse_integer(s, i, v)) return false;
-                int vi = (int)v;
-                if (vi < 0 || vi > 2) temp.game_type = GameType::Unknown; // clamp bad ints
-                else                  temp.game_type = static_cast<GameType>(vi);
-                has_game_type = true;
-            }
-            else if (key == "kills")
-            {
-                long long v; if (!parse_integer(s, i, v)) return false; temp.kills = (int)v; has_k=true;
-            }
-            else if (key == "deaths")
-            {
-                long long v; if (!parse_integer(s, i, v)) return false; temp.deaths = (int)v; has_d=true;
-            }
-            else if (key == "assists")
-            {
-                long long v; if (!parse_integer(s, i, v)) return false; temp.assists = (int)v; has_a=true;
-            }
-            else if (key == "rank")
-            {
-                if (!parse_string_quoted(s, i, temp.rank)) return false;
-            }
-            else if (key == "outcome")
-            {
-                if (!parse_string_quoted(s, i, temp.outcome)) return false;
-            }
-            else if (key == "session_date")
+    // The snapshot covers the journal only if nothing was appended after the
+    // copy was taken; otherwise the journal stays, and its older sections are
+    // skipped on replay because the snapshot's generation is newer.
+    static void retire_journal(const string &name, uint64_t journal_mark)
+    {
+        lock_guard<mutex> lk(g_journal_lock);
+        if (g_journal_appends != journal_mark) return;
+        std::error_code ec;
+        fs::remove(jnl_filename(name), ec);
+    }
+
+    mutex m;
+    condition_variable cv, idle;
+    deque<Job> queue;
+    bool busy = false, quit = false;
+    thread th;
+};
+
+static SaveWorker g_saver;
+
+// Queues a snapshot of `p` for the save worker. The rows are shared with
+// `p` (see SharedRows), so the calling thread only copies chunk pointers,
+// the date keys and the profile fields.
+bool save_player_async(Player &p)
+{
+    if (p.player_name.empty()) return false;
+    uint64_t mark;
+    {
+        lock_guard<mutex> lk(g_journal_lock);
+        mark = g_journal_appends;
+    }
+    p.generation++;
+    p.journal_records = 0;
+
+    auto snap = make_unique<Player>();
+    snap->player_name = p.player_name;
+    snap->preferred_game = p.preferred_game;
+    snap->achievements = p.achievements;
+    snap->generation = p.generation;
+    snap->sessions = p.sessions.snapshot();
+    g_saver.submit(std::move(snap), mark);
+    return true;
+}
+
+// Waits for queued saves; call before reading or removing profile files
+void flush_saves() { g_saver.flush(); }
+
+// Persists the latest edit: one journal record normally, a full snapshot when
+// the journal has grown large or cannot be written.
+static void persist_edit(Player &p, bool journaled)
+{
+    if (p.player_name.empty()) return;
+    if (!journaled || journal_needs_compaction(p)) save_player_async(p);
+}
+
+
+// True when a saved profile was read; otherwise `p` is a fresh profile named `name`
+bool load_player(Player &p, const string &name)
+{
+    // Binary snapshot, then JSON, then legacy TXT
+    bool loaded = load_player_bin(p, name);
+    if (loaded && p.player_name.empty()) p.player_name = name;
+
+    if (!loaded)
+    {
+        MappedFile in;
+        if (in.open(json_filename(name)))
+        {
+            p = Player();
+            bool ok = parse_player_json(in.view(), p);
+            if (!ok)
             {
-                if (!parse_string_quoted(s, i, temp.session_date)) return false;
+                draw_toast("Load failed: bad JSON. Trying legacy format...");
             }
             else
             {
-                if (!skip_value(s, i)) return false;
+                if (p.player_name.empty()) p.player_name = name;
+                loaded = true;
             }
+        }
+    }
 
-            skip_ws(s, i);
-            if (match_char(s, i, '}'))
-            {
-                if (!has_game_type) temp.game_type = parse_game_type(temp.game_name);
-                if (!has_k) temp.kills = 0;
-                if (!has_d) temp.deaths = 0;
-                if (!has_a) temp.assists = 0;
+    // Fallback: legacy TXT
+    if (!loaded) loaded = load_player_legacy(p, name);
+    if (!loaded)
+    {
+        p = Player();
+        p.player_name = name;
+    }
+
+    if (loaded) replay_journal(p, name); // edits made since the snapshot
+    evaluate_achievements(p, false);     // populate from data, no toasts at load
+    return loaded;
+}
+
+// Newest generation stored for `name`: its snapshot's, or a later journal
+// section's. A replacement saved above this supersedes everything on disk,
+// so the old journal never replays over it even if it outlives the save.
+static uint64_t newest_generation(const string &name)
+{
+    Player old;
+    load_player(old, name);     // raised to the newest section it replayed
+    uint64_t g = old.generation;
+
+    // Sections replay skipped, or a snapshot that no longer loads
+    MappedFile in;
+    if (!in.open(jnl_filename(name))) return g;
+    string_view s = in.view();
+    for (size_t pos = 0; pos < s.size(); )
+    {
+        size_t eol = min(s.find('\n', pos), s.size());
+        string_view line = s.substr(pos, eol - pos);
+        size_t i = 2;
+        long long v;
+        if (line.size() > 2 && line[0] == 'G' && line[1] == ' ' && parse_integer(line, i, v) && v > 0)
+            g = max(g, (uint64_t)v);
+        pos = eol + 1;
+    }
+    return g;
+}
+
+// =======================================================
+// UI flows (Sessions, Analytics, Profiles)
+// =======================================================
+void add_session(Player &p)
+{
+    try
+    {
+        Session s{};
+        s.game_type   = prompt_until_ok([&]{ return parse_game_with_name(s.game_name); });
+        s.kills       = prompt_until_ok([&]{ return parse_int_in_range("Kills (0-1000):", 0, 1000); });
+        s.deaths      = prompt_until_ok([&]{ return parse_int_in_range("Deaths (0-1000):", 0, 1000); });
+        s.assists     = prompt_until_ok([&]{ return parse_int_in_range("Assists (0-1000):", 0, 1000); });
+        s.rank        = prompt_until_ok([&]{ return parse_nonempty("Rank (e.g., Gold 2):"); });
+        s.outcome     = prompt_until_ok([&]{ return parse_outcome(); });
+        s.session_date= prompt_until_ok([&]{ return parse_nonempty("Session date (YYYY-MM-DD):"); });
+
+        size_t unlocked_before = p.achievements.size();
+        p.sessions.push_back(std::move(s)); // normalizes game_type
+        evaluate_achievements(p, true); // toast any new unlocks
+        draw_toast("Session added.");
+        if (!p.player_name.empty()) persist_edit(p, journal_add_session(p, unlocked_before));
+    }
+    catch (const exception &e)
+    {
+        draw_toast(string("Could not add session: ") + e.what());
+    }
+}
+
+// -----------------------------------------
+// Session list (virtualized)
+// -----------------------------------------
+// A scrollable list over every session in insertion order, or over one
+// game's sessions by date. Only the rows inside the viewport are formatted
+// and drawn, so a frame costs the same at 10 rows or 1M. Row strings are
+// cached per row as they scroll into view.
+struct SessionListView
+{
+    static constexpr int TOP = 70, BOTTOM = 40, PITCH = 78, CARD_H = 70;
+
+    struct RowText
+    {
+        string head, kdas, right;
+        color tint;
+    };
+
+    const Player &p;
+    GameType filter;
+    bool dated;                          // positions follow by_date(filter)
+    double scroll = 0.0, target = 0.0;   // pixels from the top of the list
+    int view_h = 0;
+    unordered_map<int, RowText> rows;    // row -> formatted text
+
+    SessionListView(const Player &pl, GameType f, bool by_date) : p(pl), filter(f), dated(by_date) {}
+
+    size_t count() const { return dated ? p.sessions.by_date(filter).size() : p.sessions.size(); }
+    int row_at(size_t pos) const { return dated ? p.sessions.by_date(filter)[pos] : (int)pos; }
+    double max_scroll() const { return max(0.0, (double)count() * PITCH - view_h); }
+
+    const RowText &text(size_t pos)
+    {
+        int r = row_at(pos);
+        auto it = rows.find(r);
+        if (it != rows.end()) return it->second;
+        if (rows.size() >= 2048) rows.clear();     // only ever a few screens' worth in use
+
+        const Session &s = p.sessions[r];
+        RowText t;
+        t.head = to_string(pos + 1) + ". " + s.session_date + " | " + s.game_name + " | Rank: " + s.rank;
+        t.kdas = "K/D/A: " + to_string(s.kills) + "/" + to_string(s.deaths) + "/" + to_string(s.assists);
+        double kda = kda_for(s);
+        char kdastr[64];
+        snprintf(kdastr, sizeof(kdastr), "KDA: %.2f", kda);
+        t.right = string(kdastr) + "   |   Outcome: " + s.outcome;
+        t.tint = kda >= 2.0 ? COL_OK : (kda < 1.0 ? COL_BAD : COL_SUB);
+        return rows.emplace(r, std::move(t)).first->second;
+    }
+
+    // Positions [first, last) touching the viewport for the current scroll
+    pair<size_t, size_t> visible() const
+    {
+        size_t first = (size_t)(scroll / PITCH);
+        size_t last = (size_t)((scroll + view_h) / PITCH) + 1;
+        return { min(first, count()), min(last, count()) };
+    }
+
+    // Window height changes move the bottom limit
+    void resize(int screen_h)
+    {
+        view_h = max(PITCH, screen_h - TOP - BOTTOM);
+        target = clampd(target, 0.0, max_scroll());
+        scroll = clampd(scroll, 0.0, max_scroll());
+    }
+
+    void scroll_by(double px) { target = clampd(target + px, 0.0, max_scroll()); }
+
+    // Long jumps land within a screen of the target and ease the rest
+    void jump_to(size_t pos)
+    {
+        target = clampd((double)pos * PITCH, 0.0, max_scroll());
+        if (fabs(target - scroll) > view_h) scroll = target + (target > scroll ? -view_h : view_h);
+    }
+
+    // One easing step; true while still moving
+    bool animate()
+    {
+        double d = target - scroll;
+        if (d == 0.0) return false;
+        scroll = fabs(d) < 0.5 ? target : scroll + d * 0.35;
+        return true;
+    }
+
+    // First position dated on or after `key`
+    size_t position_of_date(int key) const
+    {
+        const vector<int> &o = p.sessions.by_date(filter);
+        pair<size_t, size_t> r = p.sessions.date_range(filter, key, 99991231);
+        if (r.first >= o.size()) return count() ? count() - 1 : 0;
+        return dated ? r.first : (size_t)o[r.first];
+    }
+
+    void draw(const string &title)
+    {
+        draw_bg_with_dimmer(0.45);
+        int x = 24, w = screen_width() - 48 - 14;
+        pair<size_t, size_t> vis = visible();
+        double y = TOP - (scroll - (double)vis.first * PITCH);
+        for (size_t pos = vis.first; pos < vis.second; ++pos, y += PITCH)
+        {
+            const RowText &t = text(pos);
+            draw_card_row(x, y, w, CARD_H);
+            draw_ui_text(t.head, COL_TEXT, x + 8, y + 8, 18);
+            draw_ui_text(t.kdas, COL_SUB, x + 8, y + 36, 16);
+            draw_ui_text(t.right, t.tint, x + 240, y + 36, 16);
+        }
+
+        // Scrollbar
+        double track = view_h, total = max(1.0, (double)count() * PITCH);
+        double thumb = max(20.0, track * min(1.0, view_h / total));
+        double at = max_scroll() > 0 ? (track - thumb) * scroll / max_scroll() : 0.0;
+        fill_rectangle(COL_CARD, screen_width() - 30, TOP, 6, track);
+        fill_rectangle(COL_SUB, screen_width() - 30, TOP + at, 6, thumb);
+
+        // Header and footer cover rows that are partly scrolled out
+        draw_hud(title, "UP/DOWN/Wheel: scroll   PgUp/PgDn: page   Home/End   J: jump to date   ESC: back");
+        fill_rectangle(COL_HUD, 0, 48, screen_width(), TOP - 48 - 4);
+        fill_rectangle(COL_HUD, 0, screen_height() - BOTTOM + 4, screen_width(), BOTTOM - 4);
+        string range = count() == 0 ? string("No sessions")
+                     : "Rows " + to_string(vis.first + 1) + "-" + to_string(max(vis.first + 1, vis.second))
+                       + " of " + to_string(count());
+        draw_ui_text(range, COL_SUB, x, screen_height() - 28, 16);
+    }
+};
+
+void session_list_view(const Player &p, const string &title, GameType filter, bool dated)
+{
+    SessionListView v(p, filter, dated);
+    v.resize(screen_height());
+
+    auto update = [&]
+    {
+        if (key_typed(ESCAPE_KEY) || key_typed(RETURN_KEY)) return Step::LEAVE;
+        int page = max(1, v.view_h / SessionListView::PITCH) * SessionListView::PITCH;
+        double wheel = mouse_wheel_scroll().y;
+        if (wheel != 0) v.scroll_by(-wheel * 3 * SessionListView::PITCH);
+        if (key_typed(UP_KEY)) v.scroll_by(-SessionListView::PITCH);
+        if (key_typed(DOWN_KEY)) v.scroll_by(SessionListView::PITCH);
+        if (key_typed(PAGE_UP_KEY)) v.scroll_by(-page);
+        if (key_typed(PAGE_DOWN_KEY)) v.scroll_by(page);
+        if (key_typed(HOME_KEY)) v.jump_to(0);
+        if (key_typed(END_KEY)) v.jump_to(v.count());
+        if (key_typed(J_KEY))
+        {
+            int key = 0;
+            string d = prompt_line("Jump to date (YYYY-MM-DD):");
+            if (d != "" && !parse_date_key(d, key)) draw_toast("Dates must be YYYY-MM-DD.");
+            else if (d != "") v.jump_to(v.position_of_date(key));
+        }
+        if (v.view_h != max(SessionListView::PITCH, screen_height() - SessionListView::TOP - SessionListView::BOTTOM))
+            v.resize(screen_height());
+        return v.animate() ? Step::CHANGED : Step::STAY;
+    };
+    run_scene([&] { v.draw(title); }, update);
+}
+
+void list_sessions(const Player &p)
+{
+    if (p.sessions.empty()) { draw_toast("No sessions recorded yet."); return; }
+    session_list_view(p, "Sessions", GameType::Unknown, false);
+}
+
+// Forward declaration for run_menu used below
+int run_menu(const string &title, const vector<string> &items);
+
+// Small chooser to avoid free-typed input issues
+static bool choose_game_filter(GameType &out_type, string &out_name)
+{
+    vector<string> items = { "Valorant", "CS:GO / CS2", "All Games", "Back" };
+    while (true)
+    {
+        int c = run_menu("Choose Game Filter", items);
+        if (c == -1 || c == 3) return false; // cancelled
+        if (c == 0) { out_type = GameType::Valorant; out_name = "Valorant"; return true; }
+        if (c == 1) { out_type = GameType::CSGO;     out_name = "CS:GO";   return true; }
+        if (c == 2) { out_type = GameType::Unknown;  out_name = "All";     return true; }
+    }
+}
+
+void list_sessions_filtered(const Player &p)
+{
+    if (p.sessions.empty()) { draw_toast("No sessions recorded yet."); return; }
+
+    string gname;
+    GameType g;
+    if (!choose_game_filter(g, gname)) { draw_toast("Filter cancelled."); return; }
+
+    if (sessions_by_date(p, g).empty()) { draw_toast("No sessions for " + gname + "."); return; }
+    session_list_view(p, gname + string(g == GameType::Unknown ? " (All) Sessions" : " Sessions"), g, true);
+}
+
+void show_summary(const Player &p)
+{
+    SummaryStats st = compute_summary(p);
+
+    char kda2[64]; snprintf(kda2, sizeof(kda2), "%.2f", st.avg_kda);
+    char wr2[64];  snprintf(wr2,  sizeof(wr2),  "%.2f", st.win_rate_percent);
+
+    string line1 = "Player: " + (p.player_name.empty() ? string("(unnamed)") : p.player_name)
+                 + " | Preferred: " + (p.preferred_game.empty() ? string("(unset)") : p.preferred_game) + "\n";
+    string line2 = "Total Matches: " + to_string(st.total_matches)
+                 + " | Wins: " + to_string(st.wins)
+                 + " | Losses: " + to_string(st.losses) + "\n";
+    string line3 = string("Avg KDA: ") + kda2
+                 + " | Win Rate: " + wr2 + "%\n";
+    string line4 = "Best Win Streak: " + to_string(st.best_win_streak)
+                 + " | Best Loss Streak: " + to_string(st.best_loss_streak)
+                 + " | High-KDA Streak (≥2.0): " + to_string(st.best_high_kda_streak) + "\n";
+    int cur_w = p.sessions.streaks(STREAK_WIN).current(), cur_l = p.sessions.streaks(STREAK_LOSS).current();
+    line4 += "Current Streak: " + (cur_w > 0 ? to_string(cur_w) + " win(s)" : cur_l > 0 ? to_string(cur_l) + " loss(es)" : string("none"))
+           + " | High-KDA: " + to_string(p.sessions.streaks(STREAK_HIGH_KDA).current()) + "\n";
+
+    int best_idx = find_best_session_by_kda(p);
+    string line5;
+    if (best_idx >= 0)
+    {
+        const Session &b = p.sessions[best_idx];
+        char bkd[64]; snprintf(bkd, sizeof(bkd), "%.2f", kda_for(b));
+        line5 = "Best Session: " + b.session_date + " | " + b.game_name
+              + " | K/D/A " + to_string(b.kills) + "/" + to_string(b.deaths) + "/" + to_string(b.assists)
+              + " | KDA " + bkd + "\n";
+    }
+    else line5 = "Best Session: N/A\n";
+
+    show_long_text("Summary", line1 + line2 + line3 + line4 + line5);
+}
+
+// -----------------------------------------
+// KDA Trend View (interactive)
+// -----------------------------------------
+// The trend view in two layers. The data layer (date-ordered series and
+// their pyramids) is rebuilt when the filter, rolling settings or sessions
+// change. The layout layer is what a frame draws, in pixels, for the
+// visible range; it is rebuilt when the data, screen size or zoom/pan
+// changes and never holds more than a few primitives per plot column.
+struct TrendModel
+{
+    GameType filter = GameType::Unknown;
+    bool use_rolling = false;
+    int window = 0, screen_w = 0, screen_h = 0;
+    uint64_t data_version = ~0ull;
+
+    // Visible range [view_b, view_b + view_len) in points; fractional so
+    // drags and zoom steps accumulate smoothly
+    double view_b = 0.0, view_len = 0.0;
+    size_t laid_b = 0, laid_e = 0;           // range the layout was built for
+    double vis_min = 0.0, vis_max = 0.0, vis_avg = 0.0;
+
+    vector<int> order;                       // session rows, oldest first
+    vector<double> kda, rave;                // per point
+    RangePyramid kda_lod, rave_lod, win_lod; // win_lod: 1 = win, summed per block
+
+    struct Tick { int pix; string label; };
+    struct Seg { int x1, y1, x2, y2; };
+    struct Bar { int x, w; bool win; };
+    int left = 0, right = 0, top = 0, bottom = 0, stripe_top = 0;
+    vector<Tick> y_ticks, x_ticks;
+    vector<Seg> kda_segs, rave_segs;
+    vector<point_2d> kda_dots, rave_dots;    // only when points fit one per column
+    vector<Bar> stripe;
+
+    int points() const { return (int)order.size(); }
+
+    static const int MIN_VISIBLE = 10;
+
+    void clamp_view()
+    {
+        double n = (double)order.size();
+        view_len = min(n, max(view_len, min(n, (double)MIN_VISIBLE)));
+        view_b = max(0.0, min(view_b, n - view_len));
+    }
+    void reset_view() { view_b = 0.0; view_len = (double)order.size(); }
+    size_t vis_b() const { return (size_t)view_b; }
+    size_t vis_e() const { return min(order.size(), (size_t)llround(view_b + view_len)); }
+
+    // Zoom by `factor` (< 1 zooms in) keeping the point under `anchor`
+    // (0..1 across the plot) where it is
+    void zoom(double factor, double anchor)
+    {
+        double at = view_b + anchor * view_len;
+        view_len *= factor;
+        clamp_view();
+        view_b = at - anchor * view_len;
+        clamp_view();
+    }
+    void pan(double points) { view_b += points; clamp_view(); }
+
+    bool layout_stale(int sw, int sh) const
+    {
+        return sw != screen_w || sh != screen_h || vis_b() != laid_b || vis_e() != laid_e;
+    }
+
+    bool data_stale(GameType f, bool rolling, int w, uint64_t version) const
+    {
+        return f != filter || rolling != use_rolling || w != window || version != data_version;
+    }
+
+    size_t primitives() const
+    {
+        return y_ticks.size() * 2 + x_ticks.size() * 2 + kda_segs.size() + kda_dots.size()
+             + rave_segs.size() * 2 + rave_dots.size() + stripe.size();
+    }
+};
+
+static void build_trend_data(const Player &p, TrendModel &m, GameType filter, bool use_rolling, int window)
+{
+    m.filter = filter; m.use_rolling = use_rolling; m.window = window;
+    m.data_version = p.sessions.version();
+    m.screen_w = m.screen_h = 0;             // forces a relayout
+
+    m.order = sessions_by_date(p, filter);
+    const SessionColumns &c = p.sessions.columns();
+    const size_t n = m.order.size();
+    m.kda.resize(n);
+    vector<double> wins(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        m.kda[i] = kda_at(c, m.order[i]);
+        wins[i] = (c.outcome[m.order[i]] == OUTCOME_WIN) ? 1.0 : 0.0;
+    }
+    m.kda_lod.build(m.kda, true);
+    m.win_lod.build(wins, true);
+    m.reset_view();
+
+    m.rave.clear(); m.rave_lod = RangePyramid{};
+    if (use_rolling)
+    {
+        rolling_average(m.kda, window, m.rave);
+        m.rave_lod.build(m.rave);
+    }
+}
 
-                // Final normalization to tolerate legacy/bad ints vs names
-                temp.game_type = normalized_game_type(temp.game_type, temp.game_name);
+// Polyline for points [b, e) of a series. Up to one point per column it is
+// drawn as is; denser series become one min-max bar per pixel column plus a
+// connector from the previous column's last value to this column's first.
+static void layout_series(const vector<double> &v, const RangePyramid &lod, size_t b, size_t e,
+                          int left, int w, const function<int(double)> &y_at,
+                          vector<TrendModel::Seg> &segs, vector<point_2d> &dots)
+{
+    segs.clear(); dots.clear();
+    const size_t n = e - b;
+    if (n == 0) return;
 
-                if ((int)p.sessions.size() < MAX_ALLOWED) p.sessions.push_back(temp);
-                break;
-            }
-            if (!match_char(s, i, ',')) return false;
+    if (n <= (size_t)w + 1)
+    {
+        auto x_at = [&](size_t i) { return n == 1 ? left : left + (int)round((double)(i - b) / (n - 1) * w); };
+        for (size_t i = b; i < e; ++i)
+        {
+            if (i > b) segs.push_back({ x_at(i - 1), y_at(v[i - 1]), x_at(i), y_at(v[i]) });
+            dots.push_back({ (double)x_at(i), (double)y_at(v[i]) });
         }
+        return;
+    }
 
-        skip_ws(s, i);
-        if (match_char(s, i, ']')) return true;
-        if (!match_char(s, i, ',')) return false;
+    int prev_y = y_at(v[b]);
+    for (int col = 0; col <= w; ++col)
+    {
+        size_t s = b + (size_t)((double)col / (w + 1) * n);
+        size_t t = b + (size_t)((double)(col + 1) / (w + 1) * n);
+        if (t <= s) continue;
+        double mn, mx;
+        lod.range(s, t, mn, mx);
+        int x = left + col;
+        if (col > 0) segs.push_back({ x - 1, prev_y, x, y_at(v[s]) });
+        segs.push_back({ x, y_at(mn), x, y_at(mx) });
+        prev_y = y_at(v[t - 1]);
     }
 }
 
-// Parse ["id","id2",...]
-static bool parse_string_array(const string &s, size_t &i, vector<string> &out)
+// Win/loss stripe for points [b, e): one bar per point while they fit, else
+// the majority outcome per pixel column; neighbouring bars of one colour merge.
+static void layout_stripe(const TrendModel &m, size_t b, size_t e, int left, int w, vector<TrendModel::Bar> &out)
 {
-    if (!match_char(s, i, '[')) return false;
-    skip_ws(s, i);
-    if (match_char(s, i, ']')) return true;
-    while (true)
+    out.clear();
+    const size_t n = e - b;
+    if (n == 0) return;
+    auto push = [&](int x1, int x2, bool win)
     {
-        string v;
-        if (!parse_string_quoted(s, i, v)) return false;
-        out.push_back(v);
-        skip_ws(s, i);
-        if (match_char(s, i, ']')) return true;
-        if (!match_char(s, i, ',')) return false;
+        if (!out.empty() && out.back().win == win && out.back().x + out.back().w >= x1)
+            out.back().w = max(out.back().w, x2 - out.back().x);
+        else out.push_back({ x1, max(2, x2 - x1), win });
+    };
+
+    if (n <= (size_t)w + 1)
+    {
+        auto x_at = [&](size_t i) { return n == 1 ? left : left + (int)round((double)(i - b) / (n - 1) * w); };
+        for (size_t i = b; i < e; ++i)
+        {
+            double mn, mx; m.win_lod.range(i, i + 1, mn, mx);
+            int x1 = x_at(i), x2 = (i + 1 < e) ? x_at(i + 1) : x1 + 2;
+            push(x1, max(x2, x1 + 2), mx > 0.5);
+        }
+        return;
+    }
+    for (int col = 0; col <= w; ++col)
+    {
+        size_t s = b + (size_t)((double)col / (w + 1) * n);
+        size_t t = b + (size_t)((double)(col + 1) / (w + 1) * n);
+        if (t <= s) continue;
+        double mn, mx, wins;
+        m.win_lod.range(s, t, mn, mx, &wins);
+        push(left + col, left + col + 1, wins * 2 >= (double)(t - s));
     }
 }
 
-static bool parse_player_json_string(const string &s, Player &p)
+// Lays out the visible range only; its y-range and average come from the
+// pyramids in O(log n), so zooming and panning never rescan the series
+static void layout_trend(const Player &p, TrendModel &m, int sw, int sh)
 {
-    size_t i = 0;
-    if (!match_char(s, i, '{')) return false;
+    m.screen_w = sw; m.screen_h = sh;
+    m.y_ticks.clear(); m.x_ticks.clear();
+    m.kda_segs.clear(); m.rave_segs.clear(); m.kda_dots.clear(); m.rave_dots.clear(); m.stripe.clear();
+
+    m.laid_b = m.vis_b(); m.laid_e = m.vis_e();
+    if (m.laid_b >= m.laid_e) return;
+    const size_t b = m.laid_b, e = m.laid_e;
+
+    double min_k, max_k, total;
+    m.kda_lod.range(b, e, min_k, max_k, &total);
+    m.vis_min = min_k; m.vis_max = max_k; m.vis_avg = total / (double)(e - b);
+    if (!isfinite(min_k)) min_k = 0.0;
+    if (!isfinite(max_k)) max_k = 1.0;
+    if (fabs(max_k - min_k) < 1e-9) { max_k += 1.0; min_k -= 1.0; }
+
+    m.left = 80; m.right = sw - 60;
+    m.top = 90;  m.bottom = sh - 140;
+    m.stripe_top = m.bottom + 30;
+    int w = m.right - m.left, h = m.bottom - m.top;
+    double span = max_k - min_k;
+    function<int(double)> y_at = [&](double v) { return m.bottom - (int)round((v - min_k) / span * h); };
+
+    // Outliers can stretch the range to thousands: walk the step up the
+    // 1/2/5 x 10^k ladder until at most ten ticks fit
+    double step = (span > 5.0) ? 1.0 : 0.5;
+    for (int k = 0; span / step > 10.0; ++k) step *= (k % 3 == 1) ? 2.5 : 2.0;
+    for (double yv = ceil(min_k / step) * step; yv <= max_k + 1e-9; yv += step)
+    {
+        char buf[32]; snprintf(buf, sizeof(buf), "%.2f", yv);
+        m.y_ticks.push_back({ y_at(yv), buf });
+    }
+    size_t xticks = max<size_t>(2, (e - b) / 5);
+    for (size_t i = b; i < e; i += xticks)
+    {
+        int xpix = (e - b == 1) ? m.left : m.left + (int)round((double)(i - b) / (e - b - 1) * w);
+        m.x_ticks.push_back({ xpix, p.sessions[m.order[i]].session_date });
+    }
 
-    string player_name, preferred_game;
-    vector<Session> sessions_tmp;
-    vector<string> achievements_tmp;
+    layout_series(m.kda, m.kda_lod, b, e, m.left, w, y_at, m.kda_segs, m.kda_dots);
+    if (m.use_rolling) layout_series(m.rave, m.rave_lod, b, e, m.left, w, y_at, m.rave_segs, m.rave_dots);
+    layout_stripe(m, b, e, m.left, w, m.stripe);
+}
 
-    while (true)
+void kda_trend_view(const Player &p)
+{
+    if (p.sessions.empty()) { draw_toast("No sessions to visualize."); return; }
+
+    GameType filter = GameType::Unknown; // All
+    bool use_rolling = true;
+    int window = 5;
+    TrendModel model;
+
+    auto draw = [&]
     {
-        skip_ws(s, i);
-        if (match_char(s, i, '}'))
+        if (model.data_stale(filter, use_rolling, window, p.sessions.version()))
         {
-            p.player_name = player_name;
-            p.preferred_game = preferred_game;
-            p.sessions = std::move(sessions_tmp);
-            p.achievements = std::move(achievements_tmp);
-            return true;
+            // Keep the zoom across a rolling/window toggle; a new filter starts zoomed out
+            bool same_series = model.filter == filter && model.data_version == p.sessions.version();
+            double vb = model.view_b, vl = model.view_len;
+            build_trend_data(p, model, filter, use_rolling, window);
+            if (same_series) { model.view_b = vb; model.view_len = vl; model.clamp_view(); }
         }
+        int sw = screen_width(), sh = screen_height();
+        if (model.layout_stale(sw, sh)) layout_trend(p, model, sw, sh);
 
-        string key;
-        if (!parse_string_quoted(s, i, key)) return false;
-        if (!match_char(s, i, ':')) return false;
+        draw_bg_with_dimmer(0.35);
+        draw_ui_text("KDA Trend  |  V: Filter   R: Rolling   W: Window   Wheel/+/-: Zoom   Drag/Arrows: Pan   Home: Reset   ESC: Exit",
+                     COL_SUB, 24, 24, 18);
 
-        if (key == "player_name")
+        if (model.points() == 0)
         {
-            if (!parse_string_quoted(s, i, player_name)) return false;
+            draw_ui_text("No data for this filter.", COL_EMPH, 24, 64, 20);
         }
-        else if (key == "preferred_game")
+        else
+        {
+            const TrendModel &m = model;
+            draw_line(COL_SEP, m.left, m.bottom, m.right, m.bottom);
+            draw_line(COL_SEP, m.left, m.top, m.left, m.bottom);
+
+            for (const TrendModel::Tick &t : m.y_ticks)
+            {
+                draw_line(make_rgba(255,255,255,40), m.left, t.pix, m.right, t.pix);
+                draw_ui_text(t.label, COL_SUB, m.left - 60, t.pix - 8, 16);
+            }
+            for (const TrendModel::Tick &t : m.x_ticks)
+            {
+                draw_line(make_rgba(255,255,255,40), t.pix, m.top, t.pix, m.bottom);
+                draw_ui_text(t.label, COL_SUB, t.pix - 40, m.bottom + 6, 14);
+            }
+
+            auto plot_series = [&](const vector<TrendModel::Seg> &segs, const vector<point_2d> &dots,
+                                   const color &col, int thickness)
+            {
+                for (const TrendModel::Seg &s : segs)
+                    for (int t = 0; t < thickness; ++t) draw_line(col, s.x1, s.y1 + t, s.x2, s.y2 + t);
+                for (const point_2d &d : dots) fill_circle(col, d.x, d.y, 2);
+            };
+
+            plot_series(m.kda_segs, m.kda_dots, COL_EMPH, 1);
+            if (m.use_rolling) plot_series(m.rave_segs, m.rave_dots, COL_OK, 2);
+
+            const int stripe_h = 16;
+            for (const TrendModel::Bar &bar : m.stripe)
+                fill_rectangle(bar.win ? COL_WIN : COL_LOSS, bar.x, m.stripe_top, bar.w, stripe_h);
+            draw_ui_text("Win/Loss", COL_SUB, m.left - 60, m.stripe_top - 2, 14);
+
+            string ft = (filter == GameType::Unknown ? "All" : (filter == GameType::Valorant ? "Valorant" : "CS:GO"));
+            char range[160];
+            snprintf(range, sizeof(range), "   Showing %zu of %d (%s .. %s)   KDA min %.2f / avg %.2f / max %.2f",
+                     m.laid_e - m.laid_b, m.points(),
+                     p.sessions[m.order[m.laid_b]].session_date.c_str(), p.sessions[m.order[m.laid_e - 1]].session_date.c_str(),
+                     m.vis_min, m.vis_avg, m.vis_max);
+            string tip = "Filter: " + ft + "   Rolling: " + string(use_rolling ? "ON" : "OFF") + " (W=" + to_string(window) + ")" + range;
+            draw_ui_text(tip, COL_TEXT, 24, 60, 18);
+        }
+
+        string perf = "Points: " + to_string(model.points()) + "   Primitives: " + to_string(model.primitives())
+                    + "   F3: perf";
+        draw_ui_text(perf, COL_SUB, screen_width() - 24 - ui_text_w(perf, 14), screen_height() - 28, 14);
+    };
+
+    // Held arrows and drags pan continuously, so they report CHANGED
+    auto update = [&]
+    {
+        if (key_typed(ESCAPE_KEY) || key_typed(RETURN_KEY)) return Step::LEAVE;
+        if (key_typed(V_KEY))
         {
-            if (!parse_string_quoted(s, i, preferred_game)) return false;
+            if (filter == GameType::Unknown) filter = GameType::Valorant;
+            else if (filter == GameType::Valorant) filter = GameType::CSGO;
+            else filter = GameType::Unknown;
         }
-        else if (key == "sessions")
+        if (key_typed(R_KEY)) use_rolling = !use_rolling;
+        if (key_typed(W_KEY)) window = (window == 3 ? 5 : window == 5 ? 7 : 3);
+
+        // Zoom around the cursor (wheel) or the centre (+/-); pan by drag or arrows
+        Step step = Step::STAY;
+        if (model.points() > 0)
         {
-            if (!parse_sessions_array(s, i, p)) return false; // writes into p.sessions
-            sessions_tmp = p.sessions;                         // move into temp for final assignment
-            p.sessions.clear();
+            int plot_w = max(1, model.right - model.left);
+            point_2d mp = mouse_position();
+            double anchor = min(1.0, max(0.0, (mp.x - model.left) / plot_w));
+            double wheel = mouse_wheel_scroll().y;
+            if (wheel != 0) model.zoom(pow(0.8, wheel), anchor);
+            if (key_typed(EQUALS_KEY)) model.zoom(0.8, 0.5);
+            if (key_typed(MINUS_KEY))  model.zoom(1.25, 0.5);
+            if (key_typed(HOME_KEY))   model.reset_view();
+            if (key_down(LEFT_KEY))    { model.pan(-model.view_len * 0.02); step = Step::CHANGED; }
+            if (key_down(RIGHT_KEY))   { model.pan(model.view_len * 0.02); step = Step::CHANGED; }
+            if (mouse_down(LEFT_BUTTON)) model.pan(-mouse_movement().x * model.view_len / plot_w);
         }
-        else if (key == "achievements")
+        return step;
+    };
+    run_scene(draw, update);
+}
+
+// ------------------------------------------------------
+// Stats over the last N matches (sorted by date)
+// ------------------------------------------------------
+// Positions [b, e) of the date-ordered sessions for `filter`. Counts and
+// averages come from the store's prefix sums in O(1), streaks from the
+// streak engine in O(log runs).
+SummaryStats compute_summary_window(const Player &p, GameType filter, size_t b, size_t e)
+{
+    SummaryStats st{};
+    if (b >= e) return st;
+
+    WindowSums w = p.sessions.window_sums(filter, b, e);
+    st.total_matches = (int)(e - b);
+    st.wins = w.wins;
+    st.losses = w.losses;
+
+    st.best_win_streak      = p.sessions.streaks_by_date(filter, STREAK_WIN).best_in(b, e);
+    st.best_loss_streak     = p.sessions.streaks_by_date(filter, STREAK_LOSS).best_in(b, e);
+    st.best_high_kda_streak = p.sessions.streaks_by_date(filter, STREAK_HIGH_KDA).best_in(b, e);
+
+    double avg_deaths = max(1.0, w.deaths / (double)st.total_matches);
+    double avg_kills  = w.kills / (double)st.total_matches;
+    double avg_assists= w.assists / (double)st.total_matches;
+
+    st.avg_kda = (avg_kills + avg_assists) / avg_deaths;
+    st.win_rate_percent = st.wins * 100.0 / st.total_matches;
+    return st;
+}
+
+SummaryStats compute_summary_lastN(const Player &p, int N, GameType filter = GameType::Unknown)
+{
+    size_t n = sessions_by_date(p, filter).size();
+    size_t start = (n > (size_t)max(N, 0)) ? n - (size_t)N : 0;
+    return compute_summary_window(p, filter, start, n);
+}
+
+// Sessions dated within [from_key, to_key] (parse_date_key values, inclusive)
+SummaryStats compute_summary_between(const Player &p, int from_key, int to_key, GameType filter = GameType::Unknown)
+{
+    pair<size_t, size_t> r = p.sessions.date_range(filter, from_key, to_key);
+    return compute_summary_window(p, filter, r.first, r.second);
+}
+
+// -----------------------------------------
+// Quick Stats (Last N) View
+// -----------------------------------------
+// Asks for an inclusive date range; false when cancelled or unparseable
+static bool prompt_date_range(int &from_key, int &to_key)
+{
+    string a = prompt_line("From date (YYYY-MM-DD):");
+    if (a == "") return false;
+    string b = prompt_line("To date (YYYY-MM-DD):");
+    if (b == "") return false;
+    if (!parse_date_key(a, from_key) || !parse_date_key(b, to_key))
+    {
+        draw_toast("Dates must be YYYY-MM-DD.");
+        return false;
+    }
+    if (from_key > to_key) swap(from_key, to_key);
+    return true;
+}
+
+static string date_key_text(int key)
+{
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%04d-%02d-%02d", key / 10000, key / 100 % 100, key % 100);
+    return buf;
+}
+
+void quick_stats_lastN_view(const Player &p)
+{
+    if (p.sessions.empty()) { draw_toast("No sessions recorded."); return; }
+
+    GameType filter = GameType::Unknown;
+    int N = 5;
+    bool by_dates = false;          // D switches from "last N" to a date range
+    int from_key = 0, to_key = 0;
+
+    // Recomputed only when one of these changes
+    SummaryStats stN{};
+    int cached_n = -1; GameType cached_filter = filter; bool cached_dates = false;
+    int cached_from = 0, cached_to = 0; uint64_t cached_version = ~0ull;
+
+    auto draw = [&]
+    {
+        draw_bg_with_dimmer(0.35);
+        draw_ui_text("Quick Stats  |  V: Filter   UP/DOWN: N +-1   PgUp/PgDn: N x2 /2   N: Enter N   D: Date range   L: Last N   ESC: Exit",
+                     COL_SUB, 24, 24, 18);
+
+        string ft = (filter == GameType::Unknown ? "All" : (filter == GameType::Valorant ? "Valorant" : "CS:GO"));
+        if (sessions_by_date(p, filter).empty())
         {
-            if (!parse_string_array(s, i, achievements_tmp)) return false;
+            draw_ui_text("No data for this filter.", COL_EMPH, 24, 64, 20);
         }
         else
         {
-            if (!skip_value(s, i)) return false;
+            if (cached_n != N || cached_filter != filter || cached_dates != by_dates || cached_from != from_key
+                || cached_to != to_key || cached_version != p.sessions.version())
+            {
+                stN = by_dates ? compute_summary_between(p, from_key, to_key, filter) : compute_summary_lastN(p, N, filter);
+                cached_n = N; cached_filter = filter; cached_dates = by_dates;
+                cached_from = from_key; cached_to = to_key; cached_version = p.sessions.version();
+            }
+
+            string scope = by_dates ? date_key_text(from_key) + " .. " + date_key_text(to_key) : "Last " + to_string(N);
+            char kda2[64]; snprintf(kda2, sizeof(kda2), "%.2f", stN.avg_kda);
+            char wr2[64];  snprintf(wr2,  sizeof(wr2),  "%.2f", stN.win_rate_percent);
+
+            vector<string> lines;
+            lines.push_back("Quick Stats (" + scope + ") - " + ft);
+            lines.push_back("Matches Considered: " + to_string(stN.total_matches)
+                 + " | Wins: " + to_string(stN.wins)
+                 + " | Losses: " + to_string(stN.losses));
+            lines.push_back(string("Avg KDA (") + scope + "): " + kda2
+                 + " | Win Rate: " + wr2 + "%");
+            lines.push_back("Best Win Streak (" + scope + "): " + to_string(stN.best_win_streak)
+                 + " | Best Loss Streak: " + to_string(stN.best_loss_streak)
+                 + " | High-KDA Streak (≥2.0): " + to_string(stN.best_high_kda_streak));
+
+            int y = 70;
+            for (size_t i = 0; i < lines.size(); ++i)
+            {
+                draw_ui_text(lines[i], i == 0 ? COL_TEXT : COL_EMPH, 24, y, i == 0 ? 24 : 18);
+                y += (i == 0) ? 40 : 26;
+            }
+        }
+    };
+    auto update = [&]
+    {
+        if (key_typed(ESCAPE_KEY) || key_typed(RETURN_KEY)) return Step::LEAVE;
+        if (key_typed(V_KEY))
+        {
+            if (filter == GameType::Unknown) filter = GameType::Valorant;
+            else if (filter == GameType::Valorant) filter = GameType::CSGO;
+            else filter = GameType::Unknown;
         }
 
-        skip_ws(s, i);
-        if (match_char(s, i, '}'))
+        int most = max(1, (int)p.sessions.size());
+        if (key_typed(UP_KEY))        { N = min(most, N + 1); by_dates = false; }
+        if (key_typed(DOWN_KEY))      { N = max(1, N - 1); by_dates = false; }
+        if (key_typed(PAGE_UP_KEY))   { N = min(most, N * 2); by_dates = false; }
+        if (key_typed(PAGE_DOWN_KEY)) { N = max(1, N / 2); by_dates = false; }
+        if (key_typed(L_KEY)) by_dates = false;
+        if (key_typed(N_KEY))
         {
-            p.player_name = player_name;
-            p.preferred_game = preferred_game;
-            p.sessions = std::move(sessions_tmp);
-            p.achievements = std::move(achievements_tmp);
-            return true;
+            try { N = parse_int_in_range("Last N matches (1-" + to_string(most) + "):", 1, most); by_dates = false; }
+            catch (const exception &e) { draw_toast(string("Invalid input: ") + e.what()); }
         }
-        if (!match_char(s, i, ',')) return false;
-    }
+        if (key_typed(D_KEY) && prompt_date_range(from_key, to_key)) by_dates = true;
+        return Step::STAY;
+    };
+    run_scene(draw, update);
 }
 
 // =======================================================
-// Persistence (JSON + legacy TXT support) with Atomic Save
+// Profiles: Create / Switch / Update / List / Delete
 // =======================================================
-static string safe_name(const string &raw)
+static inline string txt(double v) { char b[64]; snprintf(b, sizeof(b), "%.2f", v); return string(b); }
+
+void create_new_profile(Player &p)
 {
-    if (raw.empty()) return "default";
-    string s = raw;
-    for (char &c : s) if (strchr("/\\:*?\"<>|", c)) c = '_';
-    return s;
+    while (true)
+    {
+        string pname = prompt_line("Enter NEW player profile name:");
+        if (pname == "") { draw_toast("Creation cancelled."); return; }
+        if (profile_exists(pname)) { draw_toast("Profile already exists. Choose another name."); continue; }
+        p = Player();
+        p.player_name = pname;
+        p.preferred_game = "";
+        evaluate_achievements(p, false);
+        save_player_async(p);
+        draw_toast("New profile created: " + pname);
+        return;
+    }
 }
 
-static inline string json_filename(const string &name) { return safe_name(name) + "_data.json"; }
-static inline string txt_filename (const string &name) { return safe_name(name) + "_data.txt";  }
-static inline string bak_filename (const string &name) { return safe_name(name) + "_data.bak";  }
-static inline string tmp_filename (const string &name) { return safe_name(name) + "_data.tmp";  }
+void do_switch_profile(Player &p)
+{
+    while (true)
+    {
+        string pname = prompt_line("Switch to player profile (must exist):");
+        if (pname == "") { draw_toast("Switch cancelled."); return; }
+        if (!profile_exists(pname)) { draw_toast("Profile not found. Try again."); continue; }
+        flush_saves();
+        load_player(p, pname);
+        if (p.player_name.empty()) p.player_name = pname;
+        draw_toast("Profile loaded: " + p.player_name);
+        return;
+    }
+}
 
-bool profile_exists(const string &name)
+void update_player_info(Player &p)
 {
-    return fs::exists(json_filename(name)) || fs::exists(txt_filename(name));
+    if (p.player_name.empty())
+    {
+        draw_toast("No active profile. Create or switch to a profile first.");
+        return;
+    }
+
+    string new_name = prompt_until_ok([&]{ return parse_nonempty("Update player name:"); });
+    if (new_name != p.player_name) p.player_name = new_name;
+    p.preferred_game = prompt_until_ok([&]{ return parse_nonempty("Update preferred FPS game:"); });
+    save_player_async(p);
+    draw_toast("Profile info updated.");
 }
 
-static bool load_player_legacy(Player &p, const string &name)
+// Profiles in the working directory as (name, format), first format found wins
+vector<pair<string, string>> find_profiles()
 {
-    string f = txt_filename(name);
-    ifstream in(f);
-    if (!in) return false;
+    static const pair<const char *, const char *> suffixes[] = {
+        { "_data.bin", "bin" }, { "_data.json", "json" }, { "_data.txt", "legacy" },
+    };
+    vector<pair<string, string>> found;
+    unordered_set<string> names;
 
-    p = Player();
+    for (const auto &entry : fs::directory_iterator("."))
+    {
+        if (!entry.is_regular_file()) continue;
+        string fname = entry.path().filename().string();
+        for (const auto &sfx : suffixes)
+        {
+            size_t n = strlen(sfx.first);
+            if (fname.size() <= n || fname.compare(fname.size() - n, n, sfx.first) != 0) continue;
+            string prof_name = fname.substr(0, fname.size() - n);
+            if (names.insert(prof_name).second) found.emplace_back(prof_name, sfx.second);
+            break;
+        }
+    }
+    sort(found.begin(), found.end());
+    return found;
+}
 
-    getline(in, p.player_name);
-    getline(in, p.preferred_game);
+void list_profiles()
+{
+    vector<pair<string, string>> found = find_profiles();
+    if (found.empty()) { draw_toast("No profiles found."); return; }
 
-    int n;
-    if (!(in >> n)) { draw_toast("Legacy load failed: invalid file."); return false; }
-    in.ignore();
+    string report = "Existing Profiles:\n\n";
+    for (const auto &f : found) report += "- " + f.first + " (" + f.second + ")\n";
+    show_long_text("Profiles", report);
+}
 
-    for (int i = 0; i < n; ++i)
+// -----------------------------------------
+// Leaderboard: every profile loaded on a worker pool
+// -----------------------------------------
+struct LeaderboardEntry
+{
+    string name;
+    SummaryStats st;
+    bool loaded = false;   // false: save file present but unreadable
+};
+
+// Loads `names` on up to `threads` workers (0 = one per core). Finished
+// entries are collected by take() in completion order; cancel() stops the
+// workers after the profile each is on, and the destructor joins them.
+struct ProfileLoader
+{
+    explicit ProfileLoader(vector<string> n, unsigned threads = 0) : names(std::move(n))
     {
-        Session s{}; int gtype = 0;
-        if (!getline(in, s.game_name)) break;
-        if (!(in >> gtype)) break; in.ignore();
-        s.game_type = static_cast<GameType>(gtype);
-        if (!(in >> s.kills >> s.deaths >> s.assists)) break; in.ignore();
-        if (!getline(in, s.rank)) break;
-        if (!getline(in, s.outcome)) break;
-        if (!getline(in, s.session_date)) break;
+        if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+        threads = (unsigned)min<size_t>(threads, max<size_t>(1, names.size()));
+        live = threads;
+        for (unsigned t = 0; t < threads; ++t) workers.emplace_back([this] { run(); });
+    }
+    ProfileLoader(const ProfileLoader &) = delete;
+    ProfileLoader &operator=(const ProfileLoader &) = delete;
+    ~ProfileLoader() { cancel(); join(); }
+
+    void cancel() { stop = true; }
+    void join() { for (thread &t : workers) if (t.joinable()) t.join(); }
+
+    size_t total() const { return names.size(); }
+    size_t finished() const { return done; }
+    bool running() const { return live > 0; }
+    bool cancelled() const { return stop; }
+
+    vector<LeaderboardEntry> take()
+    {
+        lock_guard<mutex> lk(m);
+        vector<LeaderboardEntry> out;
+        out.swap(ready);
+        return out;
+    }
 
-        if ((int)p.sessions.size() < MAX_ALLOWED) p.sessions.push_back(s);
+private:
+    void run()
+    {
+        vector<string> notes;     // load_player's toasts must not touch the window from here
+        t_toast_sink = &notes;
+        for (size_t i; !stop && (i = next++) < names.size(); )
+        {
+            LeaderboardEntry e;
+            e.name = names[i];
+            notes.clear();
+            {
+                Player p;
+                e.loaded = load_player(p, e.name);
+                e.st = compute_summary(p);
+            }
+            {
+                lock_guard<mutex> lk(m);
+                ready.push_back(std::move(e));
+            }
+            done++;
+        }
+        t_toast_sink = nullptr;
+        live--;
     }
-    return true;
+
+    vector<string> names;
+    atomic<size_t> next{0}, done{0};
+    atomic<bool> stop{false};
+    atomic<unsigned> live{0};
+    mutex m;
+    vector<LeaderboardEntry> ready;
+    vector<thread> workers;
+};
+
+enum class BoardSort { KDA, WIN_RATE, WIN_STREAK, MATCHES };
+static const char *BOARD_SORT_NAMES[] = { "KDA", "Win rate", "Best win streak", "Matches" };
+
+static BoardSort parse_board_sort(string_view s)
+{
+    if (iequals(s, "winrate") || iequals(s, "win_rate")) return BoardSort::WIN_RATE;
+    if (iequals(s, "streak")) return BoardSort::WIN_STREAK;
+    if (iequals(s, "matches")) return BoardSort::MATCHES;
+    return BoardSort::KDA;
 }
 
-// Atomic save with backup
-void save_player(const Player &p)
+static double board_key(const SummaryStats &st, BoardSort by)
 {
-    if (p.player_name.empty()) return;
+    switch (by)
+    {
+        case BoardSort::KDA:        return st.avg_kda;
+        case BoardSort::WIN_RATE:   return st.win_rate_percent;
+        case BoardSort::WIN_STREAK: return st.best_win_streak;
+        case BoardSort::MATCHES:    return st.total_matches;
+    }
+    return 0.0;
+}
 
-    string jf  = json_filename(p.player_name);
-    string tf  = tmp_filename(p.player_name);
-    string bak = bak_filename(p.player_name);
+// Best first; ties go to the player with more matches, then by name.
+// Profiles with no matches always sort last.
+void sort_leaderboard(vector<LeaderboardEntry> &rows, BoardSort by)
+{
+    sort(rows.begin(), rows.end(), [by](const LeaderboardEntry &a, const LeaderboardEntry &b)
+    {
+        bool ea = a.st.total_matches == 0, eb = b.st.total_matches == 0;
+        if (ea != eb) return eb;
+        double ka = board_key(a.st, by), kb = board_key(b.st, by);
+        if (ka != kb) return ka > kb;
+        if (a.st.total_matches != b.st.total_matches) return a.st.total_matches > b.st.total_matches;
+        return a.name < b.name;
+    });
+}
 
-    // 1) Write to temp file
+void leaderboard_view()
+{
+    flush_saves();
+    vector<string> names;
+    for (const auto &f : find_profiles()) names.push_back(f.first);
+    if (names.empty()) { draw_toast("No profiles found."); return; }
+
+    ProfileLoader loader(std::move(names));
+    vector<LeaderboardEntry> rows;
+    BoardSort by = BoardSort::KDA;
+    int top = 0, shown = 1;
+    long long team_matches = 0, team_wins = 0;
+
+    auto draw = [&]
     {
-        ofstream out(tf, ios::trunc);
-        if (!out)
+        draw_bg_with_dimmer(0.45);
+        draw_hud("Leaderboard", string("by ") + BOARD_SORT_NAMES[(int)by]
+                 + "   TAB: sort   UP/DOWN/PgUp/PgDn: scroll   C: cancel   ESC: back");
+
+        int x = 24, y = 64, w = screen_width() - 48;
+        string status;
+        if (loader.running())
         {
-            draw_toast("Save failed: cannot open temp file.");
-            return;
+            status = (loader.cancelled() ? "Cancelling... " : "Loading profiles: ")
+                     + to_string(loader.finished()) + " / " + to_string(loader.total());
+            fill_rectangle(COL_CARD, x, y + 26, w, 6);
+            fill_rectangle(COL_EMPH, x, y + 26, w * (double)loader.finished() / loader.total(), 6);
         }
+        else if (loader.finished() < loader.total())
+            status = "Cancelled: " + to_string(loader.finished()) + " of " + to_string(loader.total()) + " profiles loaded";
+        else
+            status = to_string(loader.total()) + " profiles";
+        status += "   |   " + to_string(team_matches) + " matches   |   team win rate "
+                  + txt(team_matches ? team_wins * 100.0 / team_matches : 0.0) + "%";
+        draw_ui_text(status, COL_SUB, x, y, 18);
+        y += 44;
+
+        const int row_h = 30;
+        int cols[] = { x + 12, x + 70, x + w - 520, x + w - 400, x + w - 280, x + w - 150 };
+        const char *heads[] = { "#", "Player", "Matches", "KDA", "Win %", "Best streak" };
+        for (int c = 0; c < 6; ++c) draw_ui_text(heads[c], COL_EMPH, cols[c], y, 18);
+        y += row_h;
+        draw_sep(x, y - 6, x + w, y - 6);
+
+        shown = max(1, (screen_height() - y - 24) / row_h);
+        top = max(0, min(top, (int)rows.size() - shown));
+        for (int i = top; i < (int)rows.size() && i < top + shown; ++i)
+        {
+            const LeaderboardEntry &e = rows[i];
+            if ((i - top) % 2 == 0) draw_card_row(x, y - 4, w, row_h);
+            color c = !e.loaded ? COL_BAD : (e.st.total_matches ? COL_TEXT : COL_SUB);
+            draw_ui_text(to_string(i + 1), c, cols[0], y, 18);
+            draw_ui_text(e.loaded ? e.name : e.name + "  (unreadable)", c, cols[1], y, 18);
+            draw_ui_text(to_string(e.st.total_matches), c, cols[2], y, 18);
+            draw_ui_text(txt(e.st.avg_kda), c, cols[3], y, 18);
+            draw_ui_text(txt(e.st.win_rate_percent), c, cols[4], y, 18);
+            draw_ui_text(to_string(e.st.best_win_streak), c, cols[5], y, 18);
+            y += row_h;
+        }
+    };
 
-        out << "{\n";
-        out << "  \"player_name\": \"" << json_escape(p.player_name) << "\",\n";
-        out << "  \"preferred_game\": \"" << json_escape(p.preferred_game) << "\",\n";
-        out << "  \"sessions\": [\n";
-
-        for (int i = 0; i < (int)p.sessions.size(); ++i)
+    // Redraws while loading only when results arrive or the load stops
+    bool was_running = true, leaving = false;
+    auto update = [&]
+    {
+        Step step = Step::STAY;
+        vector<LeaderboardEntry> fresh = loader.take();
+        if (!fresh.empty())
         {
-            const Session &s = p.sessions[i];
-            out << "    {\n";
-            out << "      \"game_name\": \"" << json_escape(s.game_name) << "\",\n";
-            out << "      \"game_type\": " << static_cast<int>(s.game_type) << ",\n";
-            out << "      \"kills\": " << s.kills << ",\n";
-            out << "      \"deaths\": " << s.deaths << ",\n";
-            out << "      \"assists\": " << s.assists << ",\n";
-            out << "      \"rank\": \"" << json_escape(s.rank) << "\",\n";
-            out << "      \"outcome\": \"" << json_escape(s.outcome) << "\",\n";
-            out << "      \"session_date\": \"" << json_escape(s.session_date) << "\"\n";
-            out << "    }" << (i + 1 < (int)p.sessions.size() ? "," : "") << "\n";
+            for (LeaderboardEntry &e : fresh)
+            {
+                team_matches += e.st.total_matches;
+                team_wins += e.st.wins;
+                rows.push_back(std::move(e));
+            }
+            sort_leaderboard(rows, by);
+            step = Step::CHANGED;
         }
+        if (was_running != loader.running()) { was_running = !was_running; step = Step::CHANGED; }
 
-        out << "  ],\n";
-        out << "  \"achievements\": [";
-        for (int i = 0; i < (int)p.achievements.size(); ++i)
+        // Leaving waits, still drawing "Cancelling...", for the workers to
+        // finish the profile in hand; ~ProfileLoader then joins at once
+        if (leaving) return loader.running() ? step : Step::LEAVE;
+        if (key_typed(ESCAPE_KEY) || key_typed(RETURN_KEY))
         {
-            out << "\"" << json_escape(p.achievements[i]) << "\"";
-            if (i + 1 < (int)p.achievements.size()) out << ", ";
+            loader.cancel();
+            leaving = true;
+            return Step::CHANGED;
         }
-        out << "]\n";
-        out << "}\n";
-    }
+        if (key_typed(C_KEY)) loader.cancel();
+        if (key_typed(TAB_KEY))
+        {
+            by = (BoardSort)(((int)by + 1) % 4);
+            sort_leaderboard(rows, by);
+            top = 0;
+        }
+        if (key_typed(UP_KEY)) top--;
+        if (key_typed(DOWN_KEY)) top++;
+        if (key_typed(PAGE_UP_KEY)) top -= shown;
+        if (key_typed(PAGE_DOWN_KEY)) top += shown;
+        if (key_typed(HOME_KEY)) top = 0;
+        if (key_typed(END_KEY)) top = (int)rows.size();
+        return step;
+    };
+    run_scene(draw, update);
+}
 
-    // 2) Backup current json to .bak (best effort)
-    std::error_code ec;
-    if (fs::exists(jf))
+// JSON copy of the active profile, next to the data files
+void export_profile(const Player &p)
+{
+    if (p.player_name.empty())
     {
-        fs::copy_file(jf, bak, fs::copy_options::overwrite_existing, ec);
-        // If copy fails we still proceed, but user keeps the temp file as fallback if next step fails.
+        draw_toast("No active profile. Create or switch to a profile first.");
+        return;
     }
+    string path = safe_name(p.player_name) + "-export.json";
+    if (export_profile_json(p, path)) draw_toast("Exported to " + path);
+    else draw_toast("Export failed: could not write " + path + ".");
+}
 
-    // 3) Atomically replace: rename temp -> main
-    fs::rename(tf, jf, ec);
-    if (ec)
+void import_profile(Player &p)
+{
+    string path = prompt_line("JSON file to import (e.g. len-export.json):");
+    if (path == "") { draw_toast("Import cancelled."); return; }
+
+    Player in;
+    if (!import_profile_json(in, path)) { draw_toast("Import failed: missing file or bad JSON."); return; }
+    if (in.player_name.empty()) in.player_name = fs::path(path).stem().string();
+
+    if (profile_exists(in.player_name)
+        && !confirm_yes("Profile '" + in.player_name + "' exists. Replace it?"))
     {
-        // Try overwrite by copy if rename failed (e.g., cross-device)
-        ec.clear();
-        fs::copy_file(tf, jf, fs::copy_options::overwrite_existing, ec);
-        if (!ec)
-        {
-            fs::remove(tf); // cleanup temp
-        }
-        else
-        {
-            draw_toast("Save failed: could not replace data file.");
-            return;
-        }
+        draw_toast("Import cancelled."); return;
     }
 
-    // 4) Done
-    // draw_toast("Saved.");
+    flush_saves();
+    // Saved above the old profile's generation; save_player then retires its
+    // journal, and only once the new snapshot is safely down
+    if (profile_exists(in.player_name)) in.generation = max(in.generation, newest_generation(in.player_name));
+    if (!save_player(in)) return;
+    p = std::move(in);
+    draw_toast("Profile imported: " + p.player_name);
 }
 
-void load_player(Player &p, const string &name)
+void delete_profile(Player &p)
 {
-    // JSON first
+    list_profiles();
+
+    while (true)
     {
-        string f = json_filename(name);
-        ifstream in(f);
-        if (in)
+        string target = prompt_line("Enter profile name to DELETE (Esc to cancel):");
+        if (target == "") { draw_toast("Deletion cancelled."); return; }
+        if (!profile_exists(target)) { draw_toast("Profile not found. Try again."); continue; }
+
+        if (!confirm_yes("Are you sure you want to delete profile '" + target + "'? This cannot be undone."))
         {
-            stringstream buffer; buffer << in.rdbuf();
-            string content = buffer.str();
+            draw_toast("Deletion cancelled."); return;
+        }
+        flush_saves();  // a queued save must not recreate the files
+
+        std::error_code ec;
+        bool any = false;
+        string jf = json_filename(target);
+        string tf = txt_filename(target);
+        if (fs::exists(jf)) { any = fs::remove(jf, ec) || any; }
+        if (fs::exists(tf)) { any = fs::remove(tf, ec) || any; }
+        string bf = bin_filename(target);
+        if (fs::exists(bf)) { any = fs::remove(bf, ec) || any; }
+        fs::remove(jnl_filename(target), ec);
+
+        if (!any) { draw_toast("No files removed (permission?)."); return; }
 
+        if (to_lowercase(target) == to_lowercase(p.player_name))
+        {
             p = Player();
-            bool ok = parse_player_json_string(content, p);
-            if (!ok)
-            {
-                draw_toast("Load failed: bad JSON. Trying legacy format...");
-            }
-            else
-            {
-                if (p.player_name.empty()) p.player_name = name;
-                // normalize all sessions after load (JSON)
-                for (auto &s : p.sessions) s.game_type = normalized_game_type(s.game_type, s.game_name);
-                evaluate_achievements(p, false); // populate from data, no toasts at load
-                return;
-            }
+            draw_toast("Profile deleted and unloaded.");
         }
-    }
+        else draw_toast("Profile deleted.");
 
-    // Fallback: legacy TXT
-    if (!load_player_legacy(p, name))
-    {
-        p = Player();
-        p.player_name = name;
+        return;
     }
-    // normalize all sessions after load (legacy)
-    for (auto &s : p.sessions) s.game_type = normalized_game_type(s.game_type, s.game_name);
+}
+
+void delete_session(Player &p)
+{
+    if (p.sessions.empty()) { draw_toast("No sessions to delete."); return; }
+
+    list_sessions(p);
+
+    int idx1 = prompt_until_ok([&]{
+        return parse_int_in_range("Enter session number to delete (1-" + to_string((int)p.sessions.size()) + "):", 1, (int)p.sessions.size());
+    });
+
+    const Session &s = p.sessions[idx1 - 1];
+    string confirm_msg = "Delete session #" + to_string(idx1) + " (" + s.session_date + " | " + s.game_name + ")?";
+    if (!confirm_yes(confirm_msg)) { draw_toast("Deletion cancelled."); return; }
+
+    size_t unlocked_before = p.achievements.size();
+    p.sessions.erase(idx1 - 1);
     evaluate_achievements(p, false);
+    draw_toast("Session deleted.");
+    if (!p.player_name.empty()) persist_edit(p, journal_delete_session(p, idx1 - 1, unlocked_before));
 }
 
 // =======================================================
-// UI flows (Sessions, Analytics, Profiles)
+// Generic Menu Renderer (title + items)
 // =======================================================
-void add_session(Player &p)
+int run_menu(const string &title, const vector<string> &items)
 {
-    try
+    int choice = -1;
+    auto draw = [&]
     {
-        if ((int)p.sessions.size() >= MAX_ALLOWED) throw runtime_error("Cannot add more. Limit of 20 sessions reached.");
+        draw_bg_with_dimmer(0.35);
 
-        Session s{};
-        s.game_type   = prompt_until_ok([&]{ return parse_game_with_name(s.game_name); });
-        s.kills       = prompt_until_ok([&]{ return parse_int_in_range("Kills (0-1000):", 0, 1000); });
-        s.deaths      = prompt_until_ok([&]{ return parse_int_in_range("Deaths (0-1000):", 0, 1000); });
-        s.assists     = prompt_until_ok([&]{ return parse_int_in_range("Assists (0-1000):", 0, 1000); });
-        s.rank        = prompt_until_ok([&]{ return parse_nonempty("Rank (e.g., Gold 2):"); });
-        s.outcome     = prompt_until_ok([&]{ return parse_outcome(); });
-        s.session_date= prompt_until_ok([&]{ return parse_nonempty("Session date (YYYY-MM-DD):"); });
+        draw_ui_text(title, COL_TEXT, 20, 20, 28);
+        int y = 80;
+        for (size_t i = 0; i < items.size(); ++i)
+        {
+            draw_card_row(32, y, screen_width() - 64, 36);
+            draw_ui_text(to_string((int)i + 1) + ") " + items[i], COL_EMPH, 32, y + 8, 20);
+            y += 44;
+        }
+        draw_ui_text("Press number key or click an option. ESC to go back.", COL_SUB, 32, y + 10, 16);
+    };
+    auto update = [&]
+    {
+        if (key_typed(ESCAPE_KEY)) return Step::LEAVE;
+        static const key_code digits[] = { NUM_1_KEY, NUM_2_KEY, NUM_3_KEY, NUM_4_KEY, NUM_5_KEY,
+                                           NUM_6_KEY, NUM_7_KEY, NUM_8_KEY, NUM_9_KEY, NUM_0_KEY };
+        for (size_t i = 0; i < 10 && i < items.size(); ++i)
+            if (key_typed(digits[i])) { choice = (int)i; return Step::LEAVE; }
 
-        // ensure normalized before storing
-        s.game_type = normalized_game_type(s.game_type, s.game_name);
+        if (mouse_clicked(LEFT_BUTTON))
+        {
+            point_2d mp = mouse_position();
+            int y2 = 80;
+            for (size_t i = 0; i < items.size(); ++i)
+            {
+                rectangle btn = rectangle_from(32, y2, screen_width() - 64, 36);
+                if (point_in_rectangle(mp, btn)) { choice = (int)i; return Step::LEAVE; }
+                y2 += 44;
+            }
+        }
+        return Step::STAY;
+    };
+    run_scene(draw, update);
+    return choice;
+}
 
-        p.sessions.push_back(s);
-        evaluate_achievements(p, true); // toast any new unlocks
-        draw_toast("Session added.");
-        if (!p.player_name.empty()) save_player(p);
-    }
-    catch (const exception &e)
+// =======================================================
+// Submenus
+// =======================================================
+void profile_menu(Player &player)
+{
+    vector<string> items = {
+        "Create New Profile",
+        "Switch Profile",
+        "Update Player Info",
+        "List Existing Profiles",
+        "Delete Profile",
+        "Export Profile (JSON)",
+        "Import Profile (JSON)",
+        "Leaderboard (All Profiles)",
+        "Back"
+    };
+
+    while (true)
     {
-        draw_toast(string("Could not add session: ") + e.what());
+        int c = run_menu("Profile Management", items);
+        if (c == -1 || c == 8) return;
+        switch (c)
+        {
+            case 0: create_new_profile(player); break;
+            case 1: do_switch_profile(player); break;
+            case 2: update_player_info(player); break;
+            case 3: list_profiles(); break;
+            case 4: delete_profile(player); break;
+            case 5: export_profile(player); break;
+            case 6: import_profile(player); break;
+            case 7: leaderboard_view(); break;
+        }
     }
 }
 
-void list_sessions(const Player &p)
+void sessions_menu(Player &player)
 {
-    if (p.sessions.empty()) { draw_toast("No sessions recorded yet."); return; }
+    vector<string> items = {
+        "Add Session",
+        "List Sessions",
+        "Filter Sessions by Game",
+        "Delete Session",
+        "Back"
+    };
 
-    // Card list with paging-ish simple pause at bottom
-    draw_bg_with_dimmer(0.45);
-    draw_hud("Sessions");
+    while (true)
+    {
+        int c = run_menu("Sessions", items);
+        if (c == -1 || c == 4) return;
+        switch (c)
+        {
+            case 0: add_session(player); break;
+            case 1: list_sessions(player); break;
+            case 2: list_sessions_filtered(player); break;
+            case 3: delete_session(player); break;
+        }
+    }
+}
 
-    int x = 24, y = 70;
-    int avail_h = screen_height() - y - 40;
+void analytics_menu(Player &player)
+{
+    vector<string> items = {
+        "Show Summary",
+        "KDA Trend (interactive)",
+        "Quick Stats (Last N)",
+        "Achievements",            // NEW
+        "Back"
+    };
 
-    for (int i = 0; i < (int)p.sessions.size(); ++i)
+    while (true)
     {
-        const Session &s = p.sessions[i];
-        string head = to_string(i + 1) + ". " + s.session_date + " | " + s.game_name + " | Rank: " + s.rank;
-        string kdas = "K/D/A: " + to_string(s.kills) + "/" + to_string(s.deaths) + "/" + to_string(s.assists);
-        double kda = kda_for(s);
-
-        draw_card_row(x, y, screen_width() - 48, 70);
-        draw_ui_text(head, COL_TEXT, x + 8, y + 8, 18);
+        int c = run_menu("Analytics", items);
+        if (c == -1 || c == 4) return;
+        switch (c)
+        {
+            case 0: show_summary(player); break;
+            case 1: kda_trend_view(player); break;
+            case 2: quick_stats_lastN_view(player); break;
+            case 3: show_achievements_screen(player); break;
+        }
+    }
+}
 
-        // Format decimals to 2 places
-        char kdastr[64];
-        snprintf(kdastr, sizeof(kdastr), "KDA: %.2f", kda);
+// =======================================================
+// Window Settings (unchanged from your last good version)
+// =======================================================
+void reopen_window_at(int w, int h)
+{
+    drop_bg_cache();
+    g_text_cache.clear();
+    close_all_windows();
+    open_window("FPS Game Tracker", w, h);
+    setup_font();
+    setup_theme();
+}
 
-        string right = string(kdastr) + "   |   Outcome: " + s.outcome;
+void window_settings_menu()
+{
+    vector<string> items = {
+        "1280 x 720 (HD)",
+        "1600 x 900",
+        "1920 x 1080 (Full HD)",
+        "2560 x 1440 (QHD)",
+        "Custom...",
+        "Back"
+    };
 
-        draw_ui_text(kdas, COL_SUB, x + 8, y + 36, 16);
-        draw_ui_text(right, (kda >= 2.0 ? COL_OK : (kda < 1.0 ? COL_BAD : COL_SUB)), x + 240, y + 36, 16);
+    while (true)
+    {
+        int c = run_menu("Window Settings", items);
+        if (c == -1 || c == 5) return;
 
-        y += 78;
-        if (y > avail_h)
+        int w = 1280, h = 720;
+        if (c == 0) { w = 1280; h = 720; }
+        else if (c == 1) { w = 1600; h = 900; }
+        else if (c == 2) { w = 1920; h = 1080; }
+        else if (c == 3) { w = 2560; h = 1440; }
+        else if (c == 4)
         {
-            string pi = "Press any key to continue...";
-            int tw = ui_text_w(pi, 16);
-            draw_ui_text(pi, COL_SUB, screen_width() - tw - 20, screen_height() - 28, 16);
-            refresh_screen(60);
-            while (!(key_typed(RETURN_KEY) || key_typed(ESCAPE_KEY) || mouse_clicked(LEFT_BUTTON)
-                     || key_typed(SPACE_KEY) || key_typed(A_KEY) || key_typed(B_KEY)))
+            try
             {
-                process_events(); delay(10);
+                w = prompt_until_ok([&]{ return parse_int_in_range("Width (640-3840):", 640, 3840); });
+                h = prompt_until_ok([&]{ return parse_int_in_range("Height (480-2160):", 480, 2160); });
             }
-            draw_bg_with_dimmer(0.45);
-            draw_hud("Sessions");
-            y = 70;
+            catch (...) { draw_toast("Cancelled."); continue; }
         }
-    }
-    refresh_screen(60);
 
-    while (!(key_typed(RETURN_KEY) || key_typed(ESCAPE_KEY) || mouse_clicked(LEFT_BUTTON)
-             || key_typed(SPACE_KEY) || key_typed(A_KEY) || key_typed(B_KEY)))
-    {
-        process_events(); delay(10);
+        reopen_window_at(w, h);
+        draw_toast("Window resized to " + to_string(w) + "x" + to_string(h));
+        return;
     }
 }
 
-// Forward declaration for run_menu used below
-int run_menu(const string &title, const vector<string> &items);
-
-// Small chooser to avoid free-typed input issues
-static bool choose_game_filter(GameType &out_type, string &out_name)
+// =======================================================
+// Benchmarks (headless, run with bench store|scan|stats|kernels [N])
+// =======================================================
+static double ms_since(chrono::steady_clock::time_point t0)
 {
-    vector<string> items = { "Valorant", "CS:GO / CS2", "All Games", "Back" };
-    while (true)
-    {
-        int c = run_menu("Choose Game Filter", items);
-        if (c == -1 || c == 3) return false; // cancelled
-        if (c == 0) { out_type = GameType::Valorant; out_name = "Valorant"; return true; }
-        if (c == 1) { out_type = GameType::CSGO;     out_name = "CS:GO";   return true; }
-        if (c == 2) { out_type = GameType::Unknown;  out_name = "All";     return true; }
-    }
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
 }
 
-void list_sessions_filtered(const Player &p)
+static Session make_bench_session(int i)
 {
-    if (p.sessions.empty()) { draw_toast("No sessions recorded yet."); return; }
-
-    string gname;
-    GameType g;
-    if (!choose_game_filter(g, gname)) { draw_toast("Filter cancelled."); return; }
-
-    // Use canonical, date-sorted indices helper for consistent filtering
-    vector<int> indices = build_sorted_indices_by_date(p, g);
-
-    if (indices.empty()) { draw_toast("No sessions for " + gname + "."); return; }
-
-    draw_bg_with_dimmer(0.45);
-    draw_hud(gname + string(g == GameType::Unknown ? " (All) Sessions" : " Sessions"));
+    Session s{};
+    bool val = (i % 3 != 0);
+    s.game_name = val ? "Valorant" : "CS:GO";
+    s.game_type = val ? GameType::Valorant : GameType::CSGO;
+    s.kills   = (i * 7) % 31;
+    s.deaths  = (i * 11) % 23;
+    s.assists = (i * 5) % 17;
+    s.rank    = val ? "gold 1" : "unknown";
+    s.outcome = (i % 5 < 3) ? "Win" : "Loss";
+    char d[16];
+    snprintf(d, sizeof(d), "%04d-%02d-%02d", 2015 + (i / 372) % 10, 1 + (i / 31) % 12, 1 + i % 31);
+    s.session_date = d;
+    return s;
+}
 
-    int x = 24, y = 70;
-    for (int j = 0; j < (int)indices.size(); ++j)
+// Benchmarks run inside a throwaway directory so real profiles are never touched
+struct BenchScratch
+{
+    fs::path prev, dir;
+    BenchScratch()
     {
-        int i = indices[j];
-        const Session &s = p.sessions[i];
+        std::error_code ec;
+        prev = fs::current_path();
+        dir = fs::temp_directory_path() / "fpshd_bench";
+        fs::create_directories(dir, ec);
+        fs::current_path(dir);
+    }
+    ~BenchScratch()
+    {
+        std::error_code ec;
+        fs::current_path(prev, ec);
+        fs::remove_all(dir, ec);
+    }
+};
 
-        draw_card_row(x, y, screen_width() - 48, 70);
-        string head = to_string(j + 1) + ". " + s.session_date + " | " + s.game_name + " | Rank: " + s.rank;
-        draw_ui_text(head, COL_TEXT, x + 8, y + 8, 18);
+static uintmax_t write_bench_profile(const string &name, int n)
+{
+    Player seed;
+    seed.player_name = name;
+    seed.sessions.reserve(n);
+    for (int i = 0; i < n; ++i) seed.sessions.push_back(make_bench_session(i));
+    export_profile_json(seed, json_filename(name)); // JSON whatever the size
+    std::error_code ec;
+    return fs::file_size(json_filename(name), ec);
+}
 
-        double kda = kda_for(s);
-        char kdastr[64];
-        snprintf(kdastr, sizeof(kdastr), "KDA: %.2f", kda);
+// Load, append to and save an N-session profile in a scratch directory.
+int run_store_benchmark(int n)
+{
+    g_headless = true;
+    if (n <= 0) n = 1000000;
+    int n_append = max(1, n / 100);
 
-        string line = string("K/D/A: ") + to_string(s.kills) + "/" + to_string(s.deaths) + "/" + to_string(s.assists)
-                    + " | Outcome: " + s.outcome + " | " + kdastr;
+    BenchScratch scratch;
+    std::error_code ec;
+    uintmax_t bytes = write_bench_profile("bench", n);
+    printf("profile: %d sessions, %.1f MB\n", n, bytes / 1e6);
 
-        draw_ui_text(line, (kda >= 2.0 ? COL_OK : (kda < 1.0 ? COL_BAD : COL_SUB)), x + 8, y + 36, 16);
-        y += 78;
-        if (y > screen_height() - 80) break;
-    }
+    Player p;
+    auto t0 = chrono::steady_clock::now();
+    load_player(p, "bench");
+    double load_ms = ms_since(t0);
+    printf("load:    %10.1f ms  (%zu sessions, JSON)\n", load_ms, p.sessions.size());
 
-    refresh_screen(60);
-    while (!(key_typed(RETURN_KEY) || key_typed(ESCAPE_KEY) || mouse_clicked(LEFT_BUTTON)
-             || key_typed(SPACE_KEY) || key_typed(A_KEY) || key_typed(B_KEY)))
     {
-        process_events(); delay(10);
+        MappedFile mf;
+        mf.open(json_filename("bench"));
+        Player tmp;
+        t0 = chrono::steady_clock::now();
+        parse_player_json(mf.view(), tmp);
+        double parse_ms = ms_since(t0);
+        printf("parse:   %10.1f ms  (%.0f MB/s, JSON reader only)\n", parse_ms, bytes / 1e3 / parse_ms);
     }
-}
 
-void show_summary(const Player &p)
-{
-    SummaryStats st = compute_summary(p);
+    t0 = chrono::steady_clock::now();
+    for (int i = 0; i < n_append; ++i) p.sessions.push_back(make_bench_session(n + i));
+    double append_ms = ms_since(t0);
+    printf("append:  %10.1f ms  (%d sessions, %.3f us each)\n", append_ms, n_append, append_ms * 1000.0 / n_append);
 
-    char kda2[64]; snprintf(kda2, sizeof(kda2), "%.2f", st.avg_kda);
-    char wr2[64];  snprintf(wr2,  sizeof(wr2),  "%.2f", st.win_rate_percent);
+    const int n_journal = 100;
+    t0 = chrono::steady_clock::now();
+    for (int i = 0; i < n_journal; ++i)
+    {
+        p.sessions.push_back(make_bench_session(n + n_append + i));
+        journal_add_session(p, p.achievements.size());
+    }
+    double journal_ms = ms_since(t0);
+    printf("journal: %10.1f ms  (%d fsync'd adds, %.3f ms each)\n", journal_ms, n_journal, journal_ms / n_journal);
 
-    string line1 = "Player: " + (p.player_name.empty() ? string("(unnamed)") : p.player_name)
-                 + " | Preferred: " + (p.preferred_game.empty() ? string("(unset)") : p.preferred_game) + "\n";
-    string line2 = "Total Matches: " + to_string(st.total_matches)
-                 + " | Wins: " + to_string(st.wins)
-                 + " | Losses: " + to_string(st.losses) + "\n";
-    string line3 = string("Avg KDA: ") + kda2
-                 + " | Win Rate: " + wr2 + "%\n";
-    string line4 = "Best Win Streak: " + to_string(st.best_win_streak)
-                 + " | Best Loss Streak: " + to_string(st.best_loss_streak)
-                 + " | High-KDA Streak (≥2.0): " + to_string(st.best_high_kda_streak) + "\n";
+    t0 = chrono::steady_clock::now();
+    export_profile_json(p, "bench_export.json");
+    double export_ms = ms_since(t0);
+    uintmax_t exported = fs::file_size("bench_export.json", ec);
+    printf("export:  %10.1f ms  (%zu sessions, %.0f MB/s, JSON writer only)\n", export_ms, p.sessions.size(), exported / 1e3 / export_ms);
 
-    int best_idx = find_best_session_by_kda(p);
-    string line5;
-    if (best_idx >= 0)
+    t0 = chrono::steady_clock::now();
+    save_player(p);
+    double save_ms = ms_since(t0);
+    bool as_bin = fs::exists(bin_filename("bench"));
+    uintmax_t saved = fs::file_size(as_bin ? bin_filename("bench") : json_filename("bench"), ec);
+    printf("save:    %10.1f ms  (%zu sessions, %.1f MB %s, %.0f MB/s)\n", save_ms, p.sessions.size(), saved / 1e6,
+           as_bin ? "binary" : "JSON", saved / 1e3 / save_ms);
+
+    Player reloaded;
+    t0 = chrono::steady_clock::now();
+    load_player(reloaded, "bench");
+    double reload_ms = ms_since(t0);
+    printf("reload:  %10.1f ms  (%zu sessions, %s)\n", reload_ms, reloaded.sessions.size(), as_bin ? "binary" : "JSON");
+
+    // Background save: the copy is all that stays on the caller. Adds
+    // journaled while the write is in flight must survive a reload.
+    t0 = chrono::steady_clock::now();
+    save_player_async(p);
+    double submit_ms = ms_since(t0);
+    const int n_racing = 10;
+    for (int i = 0; i < n_racing; ++i)
     {
-        const Session &b = p.sessions[best_idx];
-        char bkd[64]; snprintf(bkd, sizeof(bkd), "%.2f", kda_for(b));
-        line5 = "Best Session: " + b.session_date + " | " + b.game_name
-              + " | K/D/A " + to_string(b.kills) + "/" + to_string(b.deaths) + "/" + to_string(b.assists)
-              + " | KDA " + bkd + "\n";
+        p.sessions.push_back(make_bench_session(n + n_append + n_journal + i));
+        journal_add_session(p, p.achievements.size());
     }
-    else line5 = "Best Session: N/A\n";
-
-    show_long_text("Summary", line1 + line2 + line3 + line4 + line5);
+    flush_saves();
+    double async_ms = ms_since(t0);
+    Player after;
+    load_player(after, "bench");
+    bool kept = after.sessions.size() == p.sessions.size();
+    printf("async:   %10.1f ms  on the caller (copy), written after %.1f ms; %d adds during the write %s\n",
+           submit_ms, async_ms, n_racing, kept ? "kept" : "LOST");
+    g_saver.stop();
+
+    return (kept && reloaded.sessions.size() == (size_t)n + n_append + n_journal) ? 0 : 1;
 }
 
-// -----------------------------------------
-// KDA Trend View (interactive)
-// -----------------------------------------
-void kda_trend_view(const Player &p)
+// Tokenizer-only pass: whitespace runs and string bodies, nothing stored
+static size_t bench_tokenize(string_view s)
 {
-    if (p.sessions.empty()) { draw_toast("No sessions to visualize."); return; }
-
-    GameType filter = GameType::Unknown; // All
-    bool use_rolling = true;
-    int window = 5;
-
+    size_t i = 0, tokens = 0;
     while (true)
     {
-        process_events();
-        draw_bg_with_dimmer(0.35);
-        draw_ui_text("KDA Trend  |  V: Filter   R: Rolling   W: Window   ESC: Exit", COL_SUB, 24, 24, 18);
-
-        vector<int> idx = build_sorted_indices_by_date(p, filter);
-        if (idx.empty())
+        skip_ws(s, i);
+        if (i >= s.size()) break;
+        if (s[i] == '\"')
         {
-            draw_ui_text("No data for this filter.", COL_EMPH, 24, 64, 20);
-            refresh_screen(60);
+            string_view body; bool escaped;
+            if (!scan_string_raw(s, i, body, escaped)) break;
         }
-        else
-        {
-            int n = (int)idx.size();
-            vector<double> kdav; kdav.reserve(n);
-            vector<bool> winv;  winv.reserve(n);
-            double min_k = 1e9, max_k = -1e9;
-
-            for (int i = 0; i < n; ++i)
-            {
-                const Session &s = p.sessions[idx[i]];
-                double k = kda_for(s);
-                kdav.push_back(k);
-                winv.push_back(is_win(s.outcome));
-                min_k = min(min_k, k);
-                max_k = max(max_k, k);
-            }
-            if (!isfinite(min_k)) min_k = 0.0;
-            if (!isfinite(max_k)) max_k = 1.0;
-            if (fabs(max_k - min_k) < 1e-9) { max_k += 1.0; min_k -= 1.0; }
-
-            vector<double> rave;
-            if (use_rolling) rolling_average(kdav, window, rave);
-
-            int left = 80, right = screen_width() - 60;
-            int top = 90, bottom = screen_height() - 140;
-            int w = right - left, h = bottom - top;
-
-            draw_line(COL_SEP, left, bottom, right, bottom);
-            draw_line(COL_SEP, left, top, left, bottom);
-
-            double span = max_k - min_k;
-            double step = (span > 5.0) ? 1.0 : 0.5;
-            for (double yv = ceil(min_k / step) * step; yv <= max_k + 1e-9; yv += step)
-            {
-                int ypix = bottom - (int)round((yv - min_k) / span * h);
-                draw_line(make_rgba(255,255,255,40), left, ypix, right, ypix);
-                char buf[32]; snprintf(buf, sizeof(buf), "%.2f", yv);
-                draw_ui_text(buf, COL_SUB, left - 60, ypix - 8, 16);
-            }
-
-            int xticks = max(2, n / 5);
-            for (int i = 0; i < n; i += xticks)
-            {
-                int xpix = left + (int)round((double)i / (n - 1) * w);
-                draw_line(make_rgba(255,255,255,40), xpix, top, xpix, bottom);
-                const Session &s = p.sessions[idx[i]];
-                draw_ui_text(s.session_date, COL_SUB, xpix - 40, bottom + 6, 14);
-            }
-
-            auto plot_series = [&](const vector<double> &vals, const color &col, int thickness)
-            {
-                if (vals.empty()) return;
-                int px = left, py = bottom - (int)round((vals[0] - min_k) / span * h);
-                for (int i = 1; i < (int)vals.size(); ++i)
-                {
-                    int x = left + (int)round((double)i / (n - 1) * w);
-                    int y = bottom - (int)round((vals[i] - min_k) / span * h);
-                    draw_line(col, px, py, x, y);
-                    for (int t = 1; t < thickness; ++t) draw_line(col, px, py + t, x, y + t);
-                    px = x; py = y;
-                }
-                for (int i = 0; i < (int)vals.size(); ++i)
-                {
-                    int x = left + (int)round((double)i / (n - 1) * w);
-                    int y = bottom - (int)round((vals[i] - min_k) / span * h);
-                    fill_circle(col, x, y, 2);
-                }
-            };
-
-            plot_series(kdav, COL_EMPH, 1);
-            if (use_rolling) plot_series(rave, COL_OK, 2);
-
-            int stripe_top = bottom + 30;
-            int stripe_h = 16;
-            for (int i = 0; i < n; ++i)
-            {
-                int x1 = left + (int)round((double)i / (n - 1) * w);
-                int x2 = left + (int)round((double)max(i,1) / (n - 1) * w);
-                if (i + 1 < n) x2 = left + (int)round((double)(i + 1) / (n - 1) * w);
-                int width = max(2, x2 - x1);
-                color seg = winv[i] ? COL_WIN : COL_LOSS;
-                fill_rectangle(seg, x1, stripe_top, width, stripe_h);
-            }
-            draw_ui_text("Win/Loss", COL_SUB, left - 60, stripe_top - 2, 14);
-
-            string ft = (filter == GameType::Unknown ? "All" : (filter == GameType::Valorant ? "Valorant" : "CS:GO"));
-            string tip = "Filter: " + ft + "   Rolling: " + string(use_rolling ? "ON" : "OFF") + " (W=" + to_string(window) + ")";
-            draw_ui_text(tip, COL_TEXT, 24, 60, 18);
+        else i++;
+        tokens++;
+    }
+    return tokens;
+}
 
-            refresh_screen(60);
-        }
+// Scalar vs SSE2 vs AVX2 scanners over the same N-session profile.
+int run_scan_benchmark(int n)
+{
+    g_headless = true;
+    if (n <= 0) n = 200000;
+
+    BenchScratch scratch;
+    uintmax_t bytes = write_bench_profile("bench", n);
+    MappedFile mf;
+    if (!mf.open(json_filename("bench"))) return 1;
+    printf("profile: %d sessions, %.1f MB (startup pick: %s)\n", n, bytes / 1e6, g_scan.name);
+
+    vector<ByteScanner> impls = { { "scalar", scan_ws_scalar, scan_str_scalar } };
+#ifdef FPSHD_SIMD_X86
+    if (__builtin_cpu_supports("sse2")) impls.push_back({ "sse2", scan_ws_sse2, scan_str_sse2 });
+    if (__builtin_cpu_supports("avx2")) impls.push_back({ "avx2", scan_ws_avx2, scan_str_avx2 });
+#endif
+
+    ByteScanner picked = g_scan;
+    for (const ByteScanner &impl : impls)
+    {
+        g_scan = impl;
+        bench_tokenize(mf.view()); // warm the page cache
 
-        if (key_typed(ESCAPE_KEY) || key_typed(RETURN_KEY) || mouse_clicked(LEFT_BUTTON)) break;
-        if (key_typed(V_KEY))
+        // Best of three, so the first run's heap growth doesn't favour whichever impl goes last
+        size_t tokens = 0;
+        double tok_ms = 1e300, parse_ms = 1e300;
+        for (int rep = 0; rep < 3; ++rep)
         {
-            if (filter == GameType::Unknown) filter = GameType::Valorant;
-            else if (filter == GameType::Valorant) filter = GameType::CSGO;
-            else filter = GameType::Unknown;
+            auto t0 = chrono::steady_clock::now();
+            tokens = bench_tokenize(mf.view());
+            tok_ms = min(tok_ms, ms_since(t0));
+
+            Player p;
+            t0 = chrono::steady_clock::now();
+            parse_player_json(mf.view(), p);
+            parse_ms = min(parse_ms, ms_since(t0));
         }
-        if (key_typed(R_KEY)) use_rolling = !use_rolling;
-        if (key_typed(W_KEY)) window = (window == 3 ? 5 : window == 5 ? 7 : 3);
 
-        delay(10);
+        printf("%-7s tokenize %8.1f ms (%6.0f MB/s, %zu tokens)   full parse %8.1f ms (%6.0f MB/s)\n",
+               impl.name, tok_ms, bytes / 1e3 / tok_ms, tokens, parse_ms, bytes / 1e3 / parse_ms);
     }
+    g_scan = picked;
+    return 0;
 }
 
-// ------------------------------------------------------
-// Stats over the last N matches (sorted by date)
-// ------------------------------------------------------
-SummaryStats compute_summary_lastN(const Player &p, int N, GameType filter = GameType::Unknown)
+// Row-at-a-time reference for bench stats (the pre-columnar loop)
+static SummaryStats summary_from_rows(const Player &p)
 {
     SummaryStats st{};
-    vector<int> idx = build_sorted_indices_by_date(p, filter);
-    if (idx.empty()) return st;
-
-    int n = (int)idx.size();
-    int start = (n > N) ? (n - N) : 0;
-    int sum_k=0, sum_d=0, sum_a=0;
-    int cur_win=0, cur_loss=0, cur_kda=0;
-
-    for (int i = start; i < n; ++i)
+    st.total_matches = (int)p.sessions.size();
+    long long sum_kills = 0, sum_deaths = 0, sum_assists = 0;
+    int cur_win_streak = 0, cur_loss_streak = 0, cur_high_kda_streak = 0;
+    for (const auto &s : p.sessions)
     {
-        const Session &s = p.sessions[idx[i]];
-        if (is_win(s.outcome)) { st.wins++; cur_win++; st.best_win_streak = max(st.best_win_streak, cur_win); cur_loss = 0; }
-        else if (is_loss(s.outcome)) { st.losses++; cur_loss++; st.best_loss_streak = max(st.best_loss_streak, cur_loss); cur_win = 0; }
+        if (is_win(s.outcome)) { st.wins++; cur_win_streak++; st.best_win_streak = max(st.best_win_streak, cur_win_streak); cur_loss_streak = 0; }
+        else if (is_loss(s.outcome)) { st.losses++; cur_loss_streak++; st.best_loss_streak = max(st.best_loss_streak, cur_loss_streak); cur_win_streak = 0; }
+        else { cur_win_streak = cur_loss_streak = 0; }
         double k = kda_for(s);
-        if (k >= 2.0) { cur_kda++; st.best_high_kda_streak = max(st.best_high_kda_streak, cur_kda); } else cur_kda = 0;
-
-        sum_k += s.kills; sum_d += s.deaths; sum_a += s.assists;
-        st.total_matches++;
+        if (k >= 2.0) { cur_high_kda_streak++; st.best_high_kda_streak = max(st.best_high_kda_streak, cur_high_kda_streak); }
+        else cur_high_kda_streak = 0;
+        sum_kills += s.kills; sum_deaths += s.deaths; sum_assists += s.assists;
     }
-
-    double avg_deaths = st.total_matches ? max(1.0, sum_d / (double)st.total_matches) : 1.0;
-    double avg_kills  = st.total_matches ? (sum_k / (double)st.total_matches) : 0.0;
-    double avg_assists= st.total_matches ? (sum_a / (double)st.total_matches) : 0.0;
-
+    double avg_deaths  = st.total_matches ? sum_deaths / (double)st.total_matches : 1.0;
+    if (avg_deaths <= 0) avg_deaths = 1.0;
+    double avg_kills   = st.total_matches ? sum_kills  / (double)st.total_matches : 0.0;
+    double avg_assists = st.total_matches ? sum_assists/ (double)st.total_matches : 0.0;
     st.avg_kda = (avg_kills + avg_assists) / avg_deaths;
     st.win_rate_percent = st.total_matches ? (st.wins * 100.0 / st.total_matches) : 0.0;
     return st;
 }
 
-// -----------------------------------------
-// Quick Stats (Last N) View
-// -----------------------------------------
-void quick_stats_lastN_view(const Player &p)
+static bool same_summary(const SummaryStats &a, const SummaryStats &b)
 {
-    if (p.sessions.empty()) { draw_toast("No sessions recorded."); return; }
-
-    GameType filter = GameType::Unknown;
-    int N = 5;
+    return a.total_matches == b.total_matches && a.wins == b.wins && a.losses == b.losses
+        && a.avg_kda == b.avg_kda && a.win_rate_percent == b.win_rate_percent
+        && a.best_win_streak == b.best_win_streak && a.best_loss_streak == b.best_loss_streak
+        && a.best_high_kda_streak == b.best_high_kda_streak;
+}
 
-    while (true)
+// Stat functions over an in-memory N-session profile (no files involved).
+int run_stats_benchmark(int n)
+{
+    g_headless = true;
+    if (n <= 0) n = 10000000;
+
+    Player p;
+    p.player_name = "bench";
+    p.sessions.reserve(n);
+    for (int i = 0; i < n; ++i) p.sessions.push_back(make_bench_session(i));
+    printf("profile: %d sessions in memory\n", n);
+
+    auto t0 = chrono::steady_clock::now();
+    SummaryStats rows = summary_from_rows(p);
+    double rows_ms = ms_since(t0);
+
+    t0 = chrono::steady_clock::now();
+    SummaryStats cols = recompute_summary(p);
+    double cols_ms = ms_since(t0);
+    printf("recompute_summary:      %8.1f ms rows -> %8.1f ms columns  (%s)\n", rows_ms, cols_ms,
+           same_summary(rows, cols) ? "match" : "MISMATCH");
+
+    t0 = chrono::steady_clock::now();
+    SummaryStats cached = compute_summary(p);
+    printf("compute_summary:        %8.1f ms  (cached totals, %s)\n", ms_since(t0),
+           same_summary(rows, cached) ? "match" : "MISMATCH");
+
+    t0 = chrono::steady_clock::now();
+    SummaryStats last = compute_summary_lastN(p, 1000);
+    printf("compute_summary_lastN:  %8.1f ms  (N=1000, %d matches; first call builds the index)\n", ms_since(t0), last.total_matches);
+
+    t0 = chrono::steady_clock::now();
+    WindowSums all = p.sessions.window_sums(GameType::Unknown, 0, p.sessions.size());
+    printf("window sums (prefix):   %8.1f ms  (whole history, O(1) once filled; %d wins)\n", ms_since(t0), all.wins);
+
+    t0 = chrono::steady_clock::now();
+    SummaryStats year = {};
+    for (int y = 2015; y < 2025; ++y) year = compute_summary_between(p, y * 10000 + 101, y * 10000 + 1231);
+    printf("compute_summary_between:%8.3f ms  (per calendar year, %d matches in the last)\n", ms_since(t0) / 10, year.total_matches);
+
+    t0 = chrono::steady_clock::now();
+    int best = find_best_session_by_kda(p);
+    printf("find_best_session:      %8.1f ms  (#%d)\n", ms_since(t0), best);
+
+    // Deleting the oldest rows: every later run moves down a position
+    StreakRuns runs = p.sessions.streaks(STREAK_WIN);
+    const SessionColumns &c = p.sessions.columns();
+    int erased = min(n, 1000);
+    t0 = chrono::steady_clock::now();
+    for (int i = 0; i < erased; ++i) runs.erase(0, c.outcome[i] == OUTCOME_WIN);
+    printf("streak erase:           %8.4f ms  (per oldest-row delete, %d deletes, best now %d)\n",
+           ms_since(t0) / max(erased, 1), erased, runs.best());
+
+    t0 = chrono::steady_clock::now();
+    TrendModel model;
+    build_trend_data(p, model, GameType::Unknown, true, 5);
+    double data_ms = ms_since(t0);
+    t0 = chrono::steady_clock::now();
+    layout_trend(p, model, 1920, 1080);
+    printf("trend model:            %8.1f ms data + %.1f ms layout  (%d points -> %zu primitives at 1920px)\n",
+           data_ms, ms_since(t0), model.points(), model.primitives());
+
+    // Zoom into the middle and pan across; every step is a relayout of the visible range
+    t0 = chrono::steady_clock::now();
+    int steps = 0;
+    for (double f = 0.5; model.view_len > 2000; ++steps) { model.zoom(f, 0.5); layout_trend(p, model, 1920, 1080); }
+    for (int i = 0; i < 100; ++i, ++steps) { model.pan(model.view_len * 0.05); layout_trend(p, model, 1920, 1080); }
+    printf("trend zoom/pan:         %8.3f ms per relayout  (%d steps, last window %zu points)\n",
+           ms_since(t0) / steps, steps, model.laid_e - model.laid_b);
+
+    // Session list: page down 2000 screens, then jump around by date;
+    // each frame formats only the rows in view
+    t0 = chrono::steady_clock::now();
+    SessionListView list(p, GameType::Unknown, false);
+    list.resize(1080);
+    int frames = 0;
+    size_t formatted = 0;
+    auto frame = [&]
     {
-        process_events();
-        draw_bg_with_dimmer(0.35);
-        draw_ui_text("Quick Stats (Last N)  |  V: Filter   W: Window   ESC: Exit", COL_SUB, 24, 24, 18);
+        list.animate();
+        pair<size_t, size_t> vis = list.visible();
+        for (size_t pos = vis.first; pos < vis.second; ++pos) formatted += list.text(pos).head.size() ? 1 : 0;
+        ++frames;
+    };
+    for (int i = 0; i < 2000; ++i) { list.scroll_by(list.view_h); frame(); }
+    for (int i = 0; i < 200; ++i)
+    {
+        int key = 0;
+        parse_date_key(p.sessions[(int)((size_t)i * 7919 % list.count())].session_date, key);
+        list.jump_to(list.position_of_date(key));
+        for (int k = 0; k < 30; ++k) frame();
+    }
+    printf("session list:           %8.4f ms per frame  (%d frames, %.1f rows formatted/frame, %zu rows)\n",
+           ms_since(t0) / frames, frames, (double)formatted / frames, list.count());
 
-        vector<int> idxs = build_sorted_indices_by_date(p, filter);
-        if (idxs.empty())
-        {
-            draw_ui_text("No data for this filter.", COL_EMPH, 24, 64, 20);
-            refresh_screen(60);
-        }
-        else
-        {
-            SummaryStats stN = compute_summary_lastN(p, N, filter);
+    // Long text: a session dump wrapped at two window widths
+    string dump, notes = " | notes:";
+    while (notes.size() < 400) notes += " held the long angle, traded the entry, lost the retake on a late rotate;";
+    for (size_t i = 0; i < p.sessions.size() && dump.size() < (16u << 20); ++i)
+    {
+        const Session &s = p.sessions[(int)i];
+        dump += to_string(i + 1) + ". " + s.session_date + " | " + s.game_name + " | Rank: " + s.rank
+              + " | K/D/A: " + to_string(s.kills) + "/" + to_string(s.deaths) + "/" + to_string(s.assists)
+              + " | Outcome: " + s.outcome + (i % 8 == 0 ? notes : "") + "\n";
+    }
+    t0 = chrono::steady_clock::now();
+    TextLayout text(dump, 18, 22);
+    text.layout(1920 - 62);
+    double wide_ms = ms_since(t0);
+    size_t wide_lines = text.lines.size();
+    t0 = chrono::steady_clock::now();
+    text.layout(640 - 62);
+    printf("long text layout:       %8.1f ms at 1920px (%zu lines) + %.1f ms rewrap at 640px (%zu lines), %.1f MB\n",
+           wide_ms, wide_lines, ms_since(t0), text.lines.size(), dump.size() / 1e6);
+
+    // 500 synthetic tiered rules, evaluated after each append. They share 12
+    // stat slots: matches, wins, five streak rules and five last-N windows
+    vector<string> ids;
+    vector<AchievementDef> defs;
+    for (int i = 0; i < 500; ++i) ids.push_back("bench_" + to_string(i));
+    for (int i = 0; i < 500; ++i)
+    {
+        int tier = i / 20, stat = i % 20;
+        AchievementDef d{ ids[i].c_str(), "bench", "", AchMetric::MATCHES, 0, {}, 0 };
+        if (stat < 5)       { d.metric = AchMetric::MATCHES; d.at_least = (double)n * (tier + 1) / 20; }
+        else if (stat < 10) { d.metric = AchMetric::WINS; d.at_least = (double)n * (tier + 1) / 40; }
+        else if (stat < 15) { d.metric = AchMetric::BEST_STREAK; d.streak = { StreakRule::KDA_AT_LEAST, 1.0 + stat - 10 }; d.at_least = 1 + tier; }
+        else                { d.metric = AchMetric::AVG_KDA_LAST_N; d.n = 5 << (stat - 15); d.at_least = 0.5 + tier * 0.1; }
+        defs.push_back(d);
+    }
+    AchievementEngine engine(defs.data(), defs.size());
+    engine.evaluate(p);
+    double eval_ms = 0.0;
+    t0 = chrono::steady_clock::now();
+    for (int i = 0; i < 1000; ++i)
+    {
+        Session s = make_bench_session(n + i);
+        s.session_date = "2030-01-01";             // new matches are the latest
+        p.sessions.push_back(std::move(s));
+        auto e0 = chrono::steady_clock::now();
+        engine.evaluate(p);
+        eval_ms += ms_since(e0);
+    }
+    printf("achievements (500 rules):%7.4f ms per add, %.4f ms of it evaluating  (%zu slots, %zu unlocked)\n",
+           ms_since(t0) / 1000, eval_ms / 1000, engine.slots.size(), p.achievements.size());
 
-            char kda2[64]; snprintf(kda2, sizeof(kda2), "%.2f", stN.avg_kda);
-            char wr2[64];  snprintf(wr2,  sizeof(wr2),  "%.2f", stN.win_rate_percent);
+    return (same_summary(rows, cols) && same_summary(rows, cached)) ? 0 : 1;
+}
 
-            string body;
-            body += "Matches Considered: " + to_string(stN.total_matches)
-                 + " | Wins: " + to_string(stN.wins)
-                 + " | Losses: " + to_string(stN.losses) + "\n";
-            body += string("Avg KDA (Last ") + to_string(N) + "): " + kda2
-                 + " | Win Rate: " + wr2 + "%\n";
-            body += "Best Win Streak (Last " + to_string(N) + "): " + to_string(stN.best_win_streak)
-                 + " | Best Loss Streak: " + to_string(stN.best_loss_streak)
-                 + " | High-KDA Streak (≥2.0): " + to_string(stN.best_high_kda_streak) + "\n";
+// Idle CPU of a menu left alone for `seconds`: the old fixed-rate loop
+// (redraw + refresh + delay every pass) against run_scene. Needs a window.
+int run_idle_benchmark(int seconds)
+{
+    if (seconds <= 0) seconds = 5;
+    open_window("FPS Game Tracker", 1280, 720);
+    setup_font();
+    setup_theme();
 
-            show_long_text("Quick Stats (Last " + to_string(N) + ") - " + (filter==GameType::Unknown? "All" : (filter==GameType::Valorant? "Valorant":"CS:GO")), body);
+    vector<string> items = { "Profile Management", "Sessions", "Analytics", "Achievements", "Window Settings", "Save & Exit" };
+    auto draw_menu = [&]
+    {
+        draw_bg_with_dimmer(0.35);
+        draw_ui_text("Main Menu", COL_TEXT, 20, 20, 28);
+        int y = 80;
+        for (size_t i = 0; i < items.size(); ++i)
+        {
+            draw_card_row(32, y, screen_width() - 64, 36);
+            draw_ui_text(to_string((int)i + 1) + ") " + items[i], COL_EMPH, 32, y + 8, 20);
+            y += 44;
         }
+    };
+    auto measure = [&](const char *label, const function<uint64_t(uint32_t)> &loop)
+    {
+        clock_t c0 = clock();
+        auto t0 = chrono::steady_clock::now();
+        uint64_t frames = loop(current_ticks() + (uint32_t)seconds * 1000);
+        double wall_ms = ms_since(t0);
+        double cpu_ms = (double)(clock() - c0) * 1000.0 / CLOCKS_PER_SEC;
+        printf("%-12s CPU %5.1f%%  (%.0f ms over %.0f ms)   %6.1f redraws/s\n",
+               label, cpu_ms * 100.0 / wall_ms, cpu_ms, wall_ms, frames * 1000.0 / wall_ms);
+    };
 
-        if (key_typed(ESCAPE_KEY) || key_typed(RETURN_KEY) || mouse_clicked(LEFT_BUTTON)) return;
-        if (key_typed(V_KEY))
+    measure("fixed-rate", [&](uint32_t until)
+    {
+        uint64_t frames = 0;
+        while (current_ticks() < until)
         {
-            if (filter == GameType::Unknown) filter = GameType::Valorant;
-            else if (filter == GameType::Valorant) filter = GameType::CSGO;
-            else filter = GameType::Unknown;
+            process_events();
+            draw_menu();
+            refresh_screen(60);
+            frames++;
+            delay(16);
         }
-        if (key_typed(W_KEY)) N = (N == 3 ? 5 : N == 5 ? 7 : 3);
-
-        delay(10);
-    }
-}
-
-// =======================================================
-// Profiles: Create / Switch / Update / List / Delete
-// =======================================================
-static inline string txt(double v) { char b[64]; snprintf(b, sizeof(b), "%.2f", v); return string(b); }
-
-void create_new_profile(Player &p)
-{
-    while (true)
+        return frames;
+    });
+    measure("run_scene", [&](uint32_t until)
     {
-        string pname = prompt_line("Enter NEW player profile name:");
-        if (pname == "") { draw_toast("Creation cancelled."); return; }
-        if (profile_exists(pname)) { draw_toast("Profile already exists. Choose another name."); continue; }
-        p = Player();
-        p.player_name = pname;
-        p.preferred_game = "";
-        evaluate_achievements(p, false);
-        save_player(p);
-        draw_toast("New profile created: " + pname);
-        return;
-    }
+        uint64_t before = g_scene.frames;
+        run_scene(draw_menu, [&] { return current_ticks() < until ? Step::STAY : Step::LEAVE; });
+        return g_scene.frames - before;
+    });
+    printf("%s\n", g_text_cache.label_stats().c_str());
+
+    close_all_windows();
+    return 0;
 }
 
-void do_switch_profile(Player &p)
+// Scalar vs AVX2 aggregation kernels over the same columns; the outputs
+// (sums, counts and every per-match KDA) must be bit-identical.
+int run_kernel_benchmark(int n)
 {
-    while (true)
+    g_headless = true;
+    if (n <= 0) n = 10000000;
+
+    Player p;
+    p.sessions.reserve(n);
+    for (int i = 0; i < n; ++i) p.sessions.push_back(make_bench_session(i));
+    const SessionColumns &c = p.sessions.columns();
+    printf("profile: %d sessions in memory (startup pick: %s)\n", n, g_aggregate.name);
+
+    vector<AggregateKernel> impls = { { "scalar", aggregate_scalar } };
+#ifdef FPSHD_SIMD_X86
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) impls.push_back({ "avx2", aggregate_avx2 });
+#endif
+
+    bool all_match = true;
+    KdaAggregate ref_agg;
+    vector<double> ref_kda, kda(c.size());
+    for (const AggregateKernel &impl : impls)
     {
-        string pname = prompt_line("Switch to player profile (must exist):");
-        if (pname == "") { draw_toast("Switch cancelled."); return; }
-        if (!profile_exists(pname)) { draw_toast("Profile not found. Try again."); continue; }
-        load_player(p, pname);
-        if (p.player_name.empty()) p.player_name = pname;
-        draw_toast("Profile loaded: " + p.player_name);
-        return;
+        KdaAggregate agg;
+        auto t0 = chrono::steady_clock::now();
+        impl.run(c, 0, c.size(), 2.0, nullptr, agg);
+        double sums_ms = ms_since(t0);
+
+        KdaAggregate agg2;
+        t0 = chrono::steady_clock::now();
+        impl.run(c, 0, c.size(), 2.0, kda.data(), agg2);
+        double kda_ms = ms_since(t0);
+
+        bool match = true;
+        if (ref_kda.empty()) { ref_agg = agg; ref_kda = kda; }
+        else
+        {
+            match = agg.kills == ref_agg.kills && agg.deaths == ref_agg.deaths && agg.assists == ref_agg.assists
+                 && agg.wins == ref_agg.wins && agg.losses == ref_agg.losses && agg.at_or_above == ref_agg.at_or_above
+                 && memcmp(kda.data(), ref_kda.data(), kda.size() * sizeof(double)) == 0;
+        }
+        all_match = all_match && match;
+        printf("%-7s aggregate %8.1f ms   aggregate+kda[] %8.1f ms   wins=%d losses=%d kda>=2: %d  (%s)\n",
+               impl.name, sums_ms, kda_ms, agg.wins, agg.losses, agg.at_or_above, match ? "match" : "MISMATCH");
     }
+
+    SummaryStats ref = summary_from_rows(p);
+    auto t0 = chrono::steady_clock::now();
+    SummaryStats st = recompute_summary(p);
+    printf("recompute_summary (%s): %.1f ms  (%s row loop)\n", g_aggregate.name, ms_since(t0),
+           same_summary(ref, st) ? "matches" : "DIFFERS FROM");
+    return (all_match && same_summary(ref, st)) ? 0 : 1;
 }
 
-void update_player_info(Player &p)
+// Reference for the date index: stable sort of the matching rows by date key
+static bool same_date_order(const Player &p, GameType filter)
 {
-    if (p.player_name.empty())
+    const SessionColumns &c = p.sessions.columns();
+    vector<int> ref;
+    for (int i = 0; i < (int)c.size(); ++i)
+        if (filter == GameType::Unknown || c.game_type[i] == (uint8_t)filter) ref.push_back(i);
+    stable_sort(ref.begin(), ref.end(), [&](int a, int b) { return c.date_key[a] < c.date_key[b]; });
+    return ref == sessions_by_date(p, filter);
+}
+
+// Prefix-sum window vs a direct loop over the same date-ordered positions
+static bool same_window_sums(const Player &p, GameType filter, size_t b, size_t e)
+{
+    const vector<int> &idx = sessions_by_date(p, filter);
+    const SessionColumns &c = p.sessions.columns();
+    WindowSums ref;
+    for (size_t i = b; i < e; ++i)
     {
-        draw_toast("No active profile. Create or switch to a profile first.");
-        return;
+        int r = idx[i];
+        ref.kills += c.kills[r]; ref.deaths += c.deaths[r]; ref.assists += c.assists[r];
+        ref.wins += (c.outcome[r] == OUTCOME_WIN); ref.losses += (c.outcome[r] == OUTCOME_LOSS);
     }
+    WindowSums w = p.sessions.window_sums(filter, b, e);
+    return w.kills == ref.kills && w.deaths == ref.deaths && w.assists == ref.assists
+        && w.wins == ref.wins && w.losses == ref.losses;
+}
 
-    string new_name = prompt_until_ok([&]{ return parse_nonempty("Update player name:"); });
-    if (new_name != p.player_name) p.player_name = new_name;
-    p.preferred_game = prompt_until_ok([&]{ return parse_nonempty("Update preferred FPS game:"); });
-    save_player(p);
-    draw_toast("Profile info updated.");
+// Streak engine vs a direct loop, in date order over [b, e) and in row order
+static bool same_streaks(const Player &p, GameType filter, const StreakRule &rule, size_t b, size_t e)
+{
+    const vector<int> &idx = sessions_by_date(p, filter);
+    const SessionColumns &c = p.sessions.columns();
+    int best = 0, cur = 0;
+    for (size_t i = b; i < e; ++i) { cur = rule.test(c, idx[i]) ? cur + 1 : 0; best = max(best, cur); }
+    int row_best = 0, row_cur = 0;
+    for (size_t r = 0; r < c.size(); ++r) { row_cur = rule.test(c, r) ? row_cur + 1 : 0; row_best = max(row_best, row_cur); }
+    const StreakRuns &rows = p.sessions.streaks(rule);
+    return p.sessions.streaks_by_date(filter, rule).best_in(b, e) == best
+        && rows.best() == row_best && rows.current() == row_cur;
 }
 
-void list_profiles()
+// Random adds/deletes against an in-memory profile; after every edit the
+// cached summary must equal a full recompute, the date index a fresh sort,
+// and a random window's prefix sums and streaks (random rule) a direct
+// loop. Outcomes and KDAs are streaky, so runs get split and merged rather
+// than only appended to, and dates mostly increase with some backdated
+// sessions, so the index's unsorted tail gets merged too.
+int run_summary_check(int edits)
 {
-    string report = "Existing Profiles:\n\n";
-    bool found_any = false;
-    unordered_set<string> names;
+    g_headless = true;
+    if (edits <= 0) edits = 20000;
 
-    for (const auto &entry : fs::directory_iterator("."))
+    Player p;
+    uint32_t rng = 12345;
+    auto next = [&]() { rng = rng * 1664525u + 1013904223u; return rng >> 8; };
+    auto random_session = [&](int i)
     {
-        if (!entry.is_regular_file()) continue;
-        string fname = entry.path().filename().string();
-        if (fname.size() > 10 && fname.substr(fname.size() - 10) == "_data.json")
+        Session s = make_bench_session(i);
+        s.outcome = (next() % 3 == 0) ? "Loss" : (next() % 7 == 0 ? "Draw" : "Win");
+        s.deaths = (int)(next() % 6);
+        if (next() % 10 == 0) s = make_bench_session((int)(next() % 4000));   // backdated
+        return s;
+    };
+
+    for (int i = 0; i < 200; ++i) p.sessions.push_back(random_session(i));
+    int failures = 0, adds = 0, deletes = 0;
+    for (int e = 0; e < edits; ++e)
+    {
+        if (p.sessions.empty() || next() % 100 < 55) { p.sessions.push_back(random_session(e)); adds++; }
+        else { p.sessions.erase(next() % p.sessions.size()); deletes++; }
+        if (!same_summary(compute_summary(p), recompute_summary(p)))
+        {
+            if (failures++ == 0) printf("mismatch after edit %d (%zu sessions)\n", e, p.sessions.size());
+        }
+        if (e % 8 == 0 && !(same_date_order(p, GameType::Unknown) && same_date_order(p, GameType::Valorant)
+                            && same_date_order(p, GameType::CSGO)))
+        {
+            if (failures++ == 0) printf("date index out of order after edit %d\n", e);
+        }
+        GameType f = (GameType)(next() % 3);
+        size_t n = sessions_by_date(p, f).size();
+        size_t wb = n ? next() % n : 0, we = n ? wb + next() % (n - wb + 1) : 0;
+        if (!same_window_sums(p, f, wb, we))
         {
-            string prof_name = fname.substr(0, fname.size() - 10);
-            if (names.insert(prof_name).second) { report += "- " + prof_name + " (json)\n"; found_any = true; }
+            if (failures++ == 0) printf("window sums differ after edit %d\n", e);
         }
-        else if (fname.size() > 9 && fname.substr(fname.size() - 9) == "_data.txt")
+        static const StreakRule rules[] = { STREAK_WIN, STREAK_LOSS, STREAK_HIGH_KDA,
+                                            { StreakRule::KDA_AT_LEAST, 3.0 }, { StreakRule::KDA_BELOW, 1.0 } };
+        if (!same_streaks(p, f, rules[next() % 5], wb, we))
         {
-            string prof_name = fname.substr(0, fname.size() - 9);
-            if (names.insert(prof_name).second) { report += "- " + prof_name + " (legacy)\n"; found_any = true; }
+            if (failures++ == 0) printf("streaks differ after edit %d\n", e);
         }
     }
-
-    if (!found_any) { draw_toast("No profiles found."); return; }
-    show_long_text("Profiles", report);
+    printf("%d adds, %d deletes, %zu sessions left: %s\n", adds, deletes, p.sessions.size(),
+           failures == 0 ? "cached summary, date index, window sums and streaks match full recompute" : "MISMATCHES");
+    return failures == 0 ? 0 : 1;
 }
 
-void delete_profile(Player &p)
+// Journal replay after the two crashes it has to survive: a snapshot whose
+// old journal was never removed, and a record torn halfway through. Edits
+// journaled after either must come back on the next load.
+int run_journal_check()
 {
-    list_profiles();
-
-    while (true)
+    g_headless = true;
+    BenchScratch scratch;
+    int failures = 0;
+    auto expect = [&](const char *what, size_t want)
     {
-        string target = prompt_line("Enter profile name to DELETE (Esc to cancel):");
-        if (target == "") { draw_toast("Deletion cancelled."); return; }
-        if (!profile_exists(target)) { draw_toast("Profile not found. Try again."); continue; }
+        Player q;
+        load_player(q, "jcheck");
+        if (q.sessions.size() == want) return;
+        printf("%s: %zu sessions after reload, expected %zu\n", what, q.sessions.size(), want);
+        failures++;
+    };
+    auto add = [](Player &p, int i)
+    {
+        p.sessions.push_back(make_bench_session(i));
+        journal_add_session(p, p.achievements.size());
+    };
 
-        if (!confirm_yes("Are you sure you want to delete profile '" + target + "'? This cannot be undone."))
-        {
-            draw_toast("Deletion cancelled."); return;
-        }
+    Player p;
+    p.player_name = "jcheck";
+    for (int i = 0; i < 10; ++i) p.sessions.push_back(make_bench_session(i));
+    save_player(p);
+    for (int i = 10; i < 13; ++i) add(p, i);
 
-        std::error_code ec;
-        bool any = false;
-        string jf = json_filename(target);
-        string tf = txt_filename(target);
-        if (fs::exists(jf)) { any = fs::remove(jf, ec) || any; }
-        if (fs::exists(tf)) { any = fs::remove(tf, ec) || any; }
+    // Stale journal: the snapshot lands but the journal it covers survives
+    std::error_code ec;
+    fs::copy_file(jnl_filename("jcheck"), "stale.journal", ec);
+    save_player(p);
+    fs::copy_file("stale.journal", jnl_filename("jcheck"), fs::copy_options::overwrite_existing, ec);
+    expect("stale journal", 13);
+    for (int i = 13; i < 15; ++i) add(p, i);
+    expect("adds after a stale journal", 15);
+
+    // Torn record: a crash mid-append, then a fresh process journals more
+    FILE *f = fopen(jnl_filename("jcheck").c_str(), "ab");
+    if (f != nullptr) { fputs("A {\"game_name\":\"Valo", f); fclose(f); }
+    expect("torn record", 15);
+    Player r;
+    load_player(r, "jcheck");
+    add(r, 15);
+    expect("adds after a torn record", 16);
+
+    printf("journal replay: %s\n", failures == 0 ? "stale journal and torn record both keep later edits" : "EDITS LOST");
+    return failures == 0 ? 0 : 1;
+}
 
-        if (!any) { draw_toast("No files removed (permission?)."); return; }
+// =======================================================
+// Headless command line
+//   fpshd <command> [args]   one JSON object per line on stdout,
+//   diagnostics on stderr; exit 0 ok, 1 failure, 2 bad usage
+// =======================================================
+static int cli_usage()
+{
+    fprintf(stderr,
+        "usage: fpshd                                   (interactive)\n"
+        "       fpshd list\n"
+        "       fpshd summary <profile>... [--game valorant|csgo] [--last N | --from YYYY-MM-DD --to YYYY-MM-DD]\n"
+        "       fpshd leaderboard [--by kda|winrate|streak|matches] [--threads N]\n"
+        "       fpshd achievements <profile>...\n"
+        "       fpshd validate <profile>...\n"
+        "       fpshd export <profile> <file.json>\n"
+        "       fpshd import <file.json> [--as <profile>] [--replace]\n"
+        "       fpshd bench store|scan|stats|kernels [N]\n"
+        "       fpshd bench idle [seconds]              (opens a window)\n"
+        "       fpshd check [edits]\n");
+    return 2;
+}
 
-        if (to_lowercase(target) == to_lowercase(p.player_name))
+struct CliArgs
+{
+    vector<string> pos;                // positional arguments after the command
+    GameType game = GameType::Unknown; // Unknown = every game
+    int last = 0;                      // > 0: only the last N matches by date
+    bool between = false;              // --from/--to given
+    int from_key = 19700101, to_key = 21001231;
+    string as_name;
+    bool replace = false;
+    BoardSort by = BoardSort::KDA;     // leaderboard order
+    int threads = 0;                   // leaderboard workers, 0 = one per core
+};
+
+// Options may appear anywhere after the command; false on a bad option
+static bool parse_cli_args(int argc, char *argv[], CliArgs &a)
+{
+    for (int i = 2; i < argc; ++i)
+    {
+        string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--replace") a.replace = true;
+        else if (arg == "--game" && has_value)
         {
-            p = Player();
-            draw_toast("Profile deleted and unloaded.");
+            string g = argv[++i];
+            a.game = parse_game_type(g);
+            if (a.game == GameType::Unknown && !iequals(g, "all")) { fprintf(stderr, "unknown game: %s\n", g.c_str()); return false; }
         }
-        else draw_toast("Profile deleted.");
-
-        return;
+        else if (arg == "--last" && has_value)
+        {
+            if (!parse_digits(argv[++i], a.last) || a.last <= 0) { fprintf(stderr, "--last needs a positive number\n"); return false; }
+        }
+        else if ((arg == "--from" || arg == "--to") && has_value)
+        {
+            if (!parse_date_key(argv[++i], arg == "--from" ? a.from_key : a.to_key))
+            {
+                fprintf(stderr, "%s needs a YYYY-MM-DD date\n", arg.c_str()); return false;
+            }
+            a.between = true;
+        }
+        else if (arg == "--as" && has_value) a.as_name = argv[++i];
+        else if (arg == "--by" && has_value) a.by = parse_board_sort(argv[++i]);
+        else if (arg == "--threads" && has_value)
+        {
+            if (!parse_digits(argv[++i], a.threads)) { fprintf(stderr, "--threads needs a number\n"); return false; }
+        }
+        else if (arg.size() > 2 && arg.compare(0, 2, "--") == 0) { fprintf(stderr, "unknown option: %s\n", arg.c_str()); return false; }
+        else a.pos.push_back(arg);
     }
+    if (a.last > 0 && a.between) { fprintf(stderr, "--last and --from/--to are exclusive\n"); return false; }
+    if (a.from_key > a.to_key) swap(a.from_key, a.to_key);
+    return true;
 }
 
-void delete_session(Player &p)
+static void cli_error(JsonWriter &w, const string &profile, const string &msg)
 {
-    if (p.sessions.empty()) { draw_toast("No sessions to delete."); return; }
-
-    list_sessions(p);
+    w.raw("{\"profile\":").str(profile).raw(",\"error\":").str(msg).raw("}\n");
+}
 
-    int idx1 = prompt_until_ok([&]{
-        return parse_int_in_range("Enter session number to delete (1-" + to_string((int)p.sessions.size()) + "):", 1, (int)p.sessions.size());
-    });
+// Loads an existing profile; writes an error line and returns false otherwise
+static bool cli_load(JsonWriter &w, Player &p, const string &name)
+{
+    if (!profile_exists(name)) { cli_error(w, name, "profile not found"); return false; }
+    if (!load_player(p, name)) { cli_error(w, name, "profile could not be read"); return false; }
+    return true;
+}
 
-    const Session &s = p.sessions[idx1 - 1];
-    string confirm_msg = "Delete session #" + to_string(idx1) + " (" + s.session_date + " | " + s.game_name + ")?";
-    if (!confirm_yes(confirm_msg)) { draw_toast("Deletion cancelled."); return; }
+static void cli_write_stats(JsonWriter &w, const SummaryStats &st)
+{
+    w.raw(",\"matches\":").num(st.total_matches);
+    w.raw(",\"wins\":").num(st.wins);
+    w.raw(",\"losses\":").num(st.losses);
+    w.raw(",\"avg_kda\":").real(st.avg_kda);
+    w.raw(",\"win_rate_percent\":").real(st.win_rate_percent);
+    w.raw(",\"best_win_streak\":").num(st.best_win_streak);
+    w.raw(",\"best_loss_streak\":").num(st.best_loss_streak);
+    w.raw(",\"best_high_kda_streak\":").num(st.best_high_kda_streak);
+}
 
-    p.sessions.erase(p.sessions.begin() + (idx1 - 1));
-    evaluate_achievements(p, false);
-    draw_toast("Session deleted.");
-    if (!p.player_name.empty()) save_player(p);
+static int cli_summary(JsonWriter &w, const CliArgs &a)
+{
+    int failures = 0;
+    for (const string &name : a.pos)
+    {
+        Player p;
+        if (!cli_load(w, p, name)) { failures++; continue; }
+
+        SummaryStats st;
+        if (a.between) st = compute_summary_between(p, a.from_key, a.to_key, a.game);
+        else if (a.last > 0) st = compute_summary_lastN(p, a.last, a.game);
+        else if (a.game != GameType::Unknown) st = compute_summary_window(p, a.game, 0, sessions_by_date(p, a.game).size());
+        else st = compute_summary(p);
+
+        w.raw("{\"profile\":").str(name);
+        w.raw(",\"game\":").str(a.game == GameType::Unknown ? "all" : game_type_to_string(a.game));
+        if (a.between) w.raw(",\"from\":").str(date_key_text(a.from_key)).raw(",\"to\":").str(date_key_text(a.to_key));
+        if (a.last > 0) w.raw(",\"last\":").num(a.last);
+        cli_write_stats(w, st);
+        w.raw(",\"achievements\":").num((long long)p.achievements.size());
+        w.raw("}\n");
+    }
+    return failures == 0 ? 0 : 1;
 }
 
-// =======================================================
-// Generic Menu Renderer (title + items)
-// =======================================================
-int run_menu(const string &title, const vector<string> &items)
+static int cli_achievements(JsonWriter &w, const CliArgs &a)
 {
-    while (true)
+    const AchievementEngine &eng = achievements();
+    int failures = 0;
+    for (const string &name : a.pos)
     {
-        process_events();
-        draw_bg_with_dimmer(0.35);
+        Player p;
+        if (!cli_load(w, p, name)) { failures++; continue; }
 
-        draw_ui_text(title, COL_TEXT, 20, 20, 28);
-        int y = 80;
-        for (size_t i = 0; i < items.size(); ++i)
+        w.raw("{\"profile\":").str(name).raw(",\"unlocked\":[");
+        bool first = true;
+        for (size_t i = 0; i < eng.count; ++i)
         {
-            draw_card_row(32, y, screen_width() - 64, 36);
-            draw_ui_text(to_string((int)i + 1) + ") " + items[i], COL_EMPH, 32, y + 8, 20);
-            y += 44;
+            if (!p.achievement_state.has(i)) continue;
+            if (!first) w.raw(",");
+            w.str(eng.defs[i].id);
+            first = false;
         }
-        draw_ui_text("Press number key or click an option. ESC to go back.", COL_SUB, 32, y + 10, 16);
-        refresh_screen(60);
-
-        if (key_typed(ESCAPE_KEY)) return -1;
-        if (key_typed(NUM_1_KEY) && items.size() >= 1) return 0;
-        if (key_typed(NUM_2_KEY) && items.size() >= 2) return 1;
-        if (key_typed(NUM_3_KEY) && items.size() >= 3) return 2;
-        if (key_typed(NUM_4_KEY) && items.size() >= 4) return 3;
-        if (key_typed(NUM_5_KEY) && items.size() >= 5) return 4;
-        if (key_typed(NUM_6_KEY) && items.size() >= 6) return 5;
-        if (key_typed(NUM_7_KEY) && items.size() >= 7) return 6;
-        if (key_typed(NUM_8_KEY) && items.size() >= 8) return 7;
-        if (key_typed(NUM_9_KEY) && items.size() >= 9) return 8;
-        if (key_typed(NUM_0_KEY) && items.size() >= 10) return 9;
-
-        if (mouse_clicked(LEFT_BUTTON))
+        w.raw("],\"locked\":[");
+        first = true;
+        for (size_t i = 0; i < eng.count; ++i)
         {
-            point_2d mp = mouse_position();
-            int y2 = 80;
-            for (size_t i = 0; i < items.size(); ++i)
-            {
-                rectangle btn = rectangle_from(32, y2, screen_width() - 64, 36);
-                if (point_in_rectangle(mp, btn)) return (int)i;
-                y2 += 44;
-            }
+            if (p.achievement_state.has(i)) continue;
+            if (!first) w.raw(",");
+            w.str(eng.defs[i].id);
+            first = false;
         }
-
-        delay(16);
+        w.raw("]}\n");
     }
+    return failures == 0 ? 0 : 1;
 }
 
-// =======================================================
-// Submenus
-// =======================================================
-void profile_menu(Player &player)
+// The same limits add_session enforces on input; rows that slipped past them
+// (hand-edited or legacy files) are reported, first 50 in detail
+static int cli_validate(JsonWriter &w, const CliArgs &a)
 {
-    vector<string> items = {
-        "Create New Profile",
-        "Switch Profile",
-        "Update Player Info",
-        "List Existing Profiles",
-        "Delete Profile",
-        "Back"
-    };
-
-    while (true)
+    static const size_t MAX_LISTED = 50;
+    int failures = 0;
+    for (const string &name : a.pos)
     {
-        int c = run_menu("Profile Management", items);
-        if (c == -1 || c == 5) return;
-        switch (c)
+        Player p;
+        if (!cli_load(w, p, name)) { failures++; continue; }
+
+        size_t issues = 0, unranked = 0;
+        JsonWriter list;
+        auto issue = [&](size_t row, const char *field, const string &why)
         {
-            case 0: create_new_profile(player); break;
-            case 1: do_switch_profile(player); break;
-            case 2: update_player_info(player); break;
-            case 3: list_profiles(); break;
-            case 4: delete_profile(player); break;
+            if (issues++ >= MAX_LISTED) return;
+            if (list.data().size() > 0) list.raw(",");
+            list.raw("{\"session\":").num((long long)row).raw(",\"field\":").str(field).raw(",\"problem\":").str(why).raw("}");
+        };
+
+        for (size_t i = 0; i < p.sessions.size(); ++i)
+        {
+            const Session &s = p.sessions[i];
+            int key = 0;
+            if (s.game_type == GameType::Unknown) issue(i, "game_name", "unknown game '" + s.game_name + "'");
+            if (s.kills < 0 || s.kills > 1000) issue(i, "kills", "outside 0-1000");
+            if (s.deaths < 0 || s.deaths > 1000) issue(i, "deaths", "outside 0-1000");
+            if (s.assists < 0 || s.assists > 1000) issue(i, "assists", "outside 0-1000");
+            if (s.rank.empty()) issue(i, "rank", "empty");
+            if (parse_outcome_id(s.outcome) == OUTCOME_OTHER) issue(i, "outcome", "not Win or Loss");
+            if (!parse_date_key(s.session_date, key)) issue(i, "session_date", "not YYYY-MM-DD");
+            if (!s.rank.empty() && p.sessions.columns().rank_ord[i] == 0) unranked++;
         }
+        if (issues > 0) failures++;
+
+        w.raw("{\"profile\":").str(name);
+        w.raw(",\"ok\":").raw(issues == 0 ? "true" : "false");
+        w.raw(",\"sessions\":").num((long long)p.sessions.size());
+        w.raw(",\"issues\":").num((long long)issues);
+        w.raw(",\"off_ladder_ranks\":").num((long long)unranked);
+        w.raw(",\"problems\":[").raw(list.data()).raw("]}\n");
     }
+    return failures == 0 ? 0 : 1;
 }
 
-void sessions_menu(Player &player)
+static int cli_export(JsonWriter &w, const CliArgs &a)
 {
-    vector<string> items = {
-        "Add Session",
-        "List Sessions",
-        "Filter Sessions by Game",
-        "Delete Session",
-        "Back"
-    };
+    if (a.pos.size() != 2) return cli_usage();
+    Player p;
+    if (!cli_load(w, p, a.pos[0])) return 1;
+    if (!export_profile_json(p, a.pos[1])) { cli_error(w, p.player_name, "could not write " + a.pos[1]); return 1; }
+    w.raw("{\"profile\":").str(a.pos[0]).raw(",\"exported\":").str(a.pos[1]);
+    w.raw(",\"sessions\":").num((long long)p.sessions.size()).raw("}\n");
+    return 0;
+}
 
-    while (true)
+// Same steps as import_profile; an existing profile is kept unless --replace
+static int cli_import(JsonWriter &w, const CliArgs &a)
+{
+    if (a.pos.size() != 1) return cli_usage();
+    const string &path = a.pos[0];
+    Player in;
+    if (!import_profile_json(in, path)) { cli_error(w, a.as_name, "missing file or bad JSON: " + path); return 1; }
+    if (!a.as_name.empty()) in.player_name = a.as_name;
+    if (in.player_name.empty()) in.player_name = fs::path(path).stem().string();
+
+    if (profile_exists(in.player_name) && !a.replace)
     {
-        int c = run_menu("Sessions", items);
-        if (c == -1 || c == 4) return;
-        switch (c)
-        {
-            case 0: add_session(player); break;
-            case 1: list_sessions(player); break;
-            case 2: list_sessions_filtered(player); break;
-            case 3: delete_session(player); break;
-        }
+        cli_error(w, in.player_name, "profile exists (use --replace)"); return 1;
     }
+
+    // See import_profile: the old journal goes only after the save succeeds
+    if (profile_exists(in.player_name)) in.generation = max(in.generation, newest_generation(in.player_name));
+    if (!save_player(in)) { cli_error(w, in.player_name, "save failed"); return 1; }
+    w.raw("{\"profile\":").str(in.player_name).raw(",\"imported\":").str(path);
+    w.raw(",\"sessions\":").num((long long)in.sessions.size()).raw("}\n");
+    return 0;
 }
 
-void analytics_menu(Player &player)
+static int cli_list(JsonWriter &w)
 {
-    vector<string> items = {
-        "Show Summary",
-        "KDA Trend (interactive)",
-        "Quick Stats (Last N)",
-        "Achievements",            // NEW
-        "Back"
-    };
+    for (const auto &f : find_profiles())
+        w.raw("{\"profile\":").str(f.first).raw(",\"format\":").str(f.second).raw("}\n");
+    return 0;
+}
 
-    while (true)
+// Every profile in the directory, ranked; load timing goes to stderr
+static int cli_leaderboard(JsonWriter &w, const CliArgs &a)
+{
+    vector<string> names;
+    for (const auto &f : find_profiles()) names.push_back(f.first);
+
+    auto t0 = chrono::steady_clock::now();
+    vector<LeaderboardEntry> rows;
     {
-        int c = run_menu("Analytics", items);
-        if (c == -1 || c == 4) return;
-        switch (c)
-        {
-            case 0: show_summary(player); break;
-            case 1: kda_trend_view(player); break;
-            case 2: quick_stats_lastN_view(player); break;
-            case 3: show_achievements_screen(player); break;
-        }
+        ProfileLoader loader(std::move(names), (unsigned)a.threads);
+        loader.join();
+        rows = loader.take();
+    }
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+    sort_leaderboard(rows, a.by);
+
+    int failures = 0;
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        const LeaderboardEntry &e = rows[i];
+        if (!e.loaded) { cli_error(w, e.name, "profile could not be read"); failures++; continue; }
+        w.raw("{\"rank\":").num((long long)i + 1).raw(",\"profile\":").str(e.name);
+        cli_write_stats(w, e.st);
+        w.raw("}\n");
     }
+    fprintf(stderr, "%zu profiles loaded in %.1f ms\n", rows.size(), ms);
+    return failures == 0 ? 0 : 1;
 }
 
-// =======================================================
-// Window Settings (unchanged from your last good version)
-// =======================================================
-void reopen_window_at(int w, int h)
+static int cli_bench(const string &what, int n)
 {
-    close_all_windows();
-    open_window("FPS Game Tracker", w, h);
-    setup_font();
-    setup_theme();
+    if (what == "store")   return run_store_benchmark(n > 0 ? n : 1000000);
+    if (what == "scan")    return run_scan_benchmark(n > 0 ? n : 200000);
+    if (what == "stats")   return run_stats_benchmark(n > 0 ? n : 10000000);
+    if (what == "kernels") return run_kernel_benchmark(n > 0 ? n : 10000000);
+    if (what == "idle")    return run_idle_benchmark(n);
+    return cli_usage();
 }
 
-void window_settings_menu()
+int run_cli(int argc, char *argv[])
 {
-    vector<string> items = {
-        "1280 x 720 (HD)",
-        "1600 x 900",
-        "1920 x 1080 (Full HD)",
-        "2560 x 1440 (QHD)",
-        "Custom...",
-        "Back"
-    };
-
-    while (true)
-    {
-        int c = run_menu("Window Settings", items);
-        if (c == -1 || c == 5) return;
+    g_headless = true;
+    string cmd = argv[1];
 
-        int w = 1280, h = 720;
-        if (c == 0) { w = 1280; h = 720; }
-        else if (c == 1) { w = 1600; h = 900; }
-        else if (c == 2) { w = 1920; h = 1080; }
-        else if (c == 3) { w = 2560; h = 1440; }
-        else if (c == 4)
-        {
-            try
-            {
-                w = prompt_until_ok([&]{ return parse_int_in_range("Width (640-3840):", 640, 3840); });
-                h = prompt_until_ok([&]{ return parse_int_in_range("Height (480-2160):", 480, 2160); });
-            }
-            catch (...) { draw_toast("Cancelled."); continue; }
-        }
+    CliArgs a;
+    if (!parse_cli_args(argc, argv, a)) return cli_usage();
+    int n = a.pos.size() > 1 ? atoi(a.pos[1].c_str()) : 0;
 
-        reopen_window_at(w, h);
-        draw_toast("Window resized to " + to_string(w) + "x" + to_string(h));
-        return;
+    if (cmd == "bench" && !a.pos.empty()) return cli_bench(a.pos[0], n);
+    if (cmd == "check")
+    {
+        int rc = run_summary_check(a.pos.empty() ? 20000 : atoi(a.pos[0].c_str()));
+        return run_journal_check() != 0 ? 1 : rc;
     }
+
+    JsonWriter w(stdout);
+    int rc;
+    if (cmd == "list") rc = cli_list(w);
+    else if (cmd == "leaderboard") rc = cli_leaderboard(w, a);
+    else if (a.pos.empty()) return cli_usage();
+    else if (cmd == "summary") rc = cli_summary(w, a);
+    else if (cmd == "achievements") rc = cli_achievements(w, a);
+    else if (cmd == "validate") rc = cli_validate(w, a);
+    else if (cmd == "export") rc = cli_export(w, a);
+    else if (cmd == "import") rc = cli_import(w, a);
+    else return cli_usage();
+
+    if (!w.finish()) return 1;
+    fflush(stdout);
+    return rc;
 }
 
 // =======================================================
 // Main
 // =======================================================
-int main()
+int main(int argc, char *argv[])
 {
+    if (argc > 1) return run_cli(argc, argv);
+
     open_window("FPS Game Tracker", 1280, 720);
     setup_font();
     setup_theme();
@@ -1933,13 +6007,16 @@ int main()
     {
         if (player.player_name.empty())
             draw_toast("Tip: set a profile name in 'Profile Management > Update Player Info' to save under your name.");
-        save_player(player);
+        save_player_async(player);
     }
     catch (const exception &e)
     {
         draw_toast(string("Save failed: ") + e.what());
     }
 
+    g_saver.stop();     // last snapshot written before the window goes
+    for (string msg; take_posted_toast(msg); ) draw_toast(msg);
+
     close_all_windows();
     return 0;
 }